@@ -0,0 +1,58 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "IndexHeap.h"
+#include "OccupancyGrid.h"
+#include "PagedArray.h"
+
+/**
+ * @brief Uniform-cost 4-connected A* that reuses its scratch buffers between queries
+ *
+ * Buffers are paged, so they only grow over the cells queries actually reach,
+ * and are invalidated afterwards by bumping a generation stamp, so
+ * steady-state queries do not allocate.
+ */
+class AStarSearch
+{
+public:
+    /**
+     * @brief Finds a shortest path between two cells
+     * @param path Receives the cells from start to goal inclusive; cleared on failure
+     * @return Whether the goal is reachable
+     */
+    bool findPath(const OccupancyGrid& grid, TileIndex start, TileIndex goal, std::vector<TileIndex>& path);
+
+    int getExpandedCount() const { return m_expandedCount; }
+
+    /**
+     * @brief Lets another thread abort a running query; checked every few hundred expansions
+     */
+    void setCancellationFlag(const std::atomic<bool>* flag) { m_cancellationFlag = flag; }
+    bool wasCancelled() const { return m_cancelled; }
+
+private:
+    struct Key
+    {
+        int f;
+        int h;
+        bool operator<(const Key& other) const { return f != other.f ? f < other.f : h < other.h; }
+    };
+
+    struct Node
+    {
+        int gScore;
+        TileIndex parent;
+        uint32_t seenGeneration;                  // g-score and parent are valid when equal to m_generation
+        uint32_t closedGeneration;                // Cell is closed when equal to m_generation
+    };
+
+    void beginQuery(int size);
+
+    PagedArray<Node> m_nodes;
+    IndexHeap<Key> m_open;
+    const std::atomic<bool>* m_cancellationFlag{};
+    uint32_t m_generation{};
+    int m_expandedCount{};
+    bool m_cancelled{};
+};
@@ -0,0 +1,114 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "AStarSearch.h"
+#include "HierarchicalPathfinder.h"
+#include "JumpPointSearch.h"
+#include "OccupancyGrid.h"
+
+/**
+ * @brief Runs path queries on a worker thread against immutable occupancy snapshots
+ *
+ * Only the newest request matters: submitting a request cancels the one that is
+ * queued or running, so rapid clicking never piles up work. The worker owns one
+ * instance of every search, so each request can pick its own algorithm.
+ */
+class AsyncPathfinder
+{
+public:
+    using Ticket = uint64_t;
+
+    enum class Algorithm
+    {
+        AStar,              // Exact search over every tile
+        JumpPoint,          // Exact search that only expands jump points
+        Hierarchical        // Cluster-level search for large boards, near-optimal
+    };
+
+    enum class Status
+    {
+        Pending,
+        Found,
+        NotFound,
+        Cancelled
+    };
+
+    AsyncPathfinder();
+    ~AsyncPathfinder();
+    AsyncPathfinder(const AsyncPathfinder&) = delete;
+    AsyncPathfinder& operator=(const AsyncPathfinder&) = delete;
+
+    /**
+     * @brief Queues a query, superseding any earlier one
+     * @return Ticket to poll for the result
+     */
+    Ticket submit(std::shared_ptr<const OccupancyGrid> snapshot, TileIndex start, TileIndex goal,
+                  Algorithm algorithm = Algorithm::AStar);
+
+    /**
+     * @brief Has the worker build the cluster graph ahead of the first hierarchical query
+     *
+     * Yields to any request submitted before the worker gets to it.
+     */
+    void prepare(std::shared_ptr<const OccupancyGrid> snapshot);
+
+    /**
+     * @brief Records a cell whose blocked state changed since the last request
+     *
+     * The worker's cluster graph outlives snapshots, so the changes travel with
+     * the next request and only the clusters around them are rebuilt.
+     */
+    void notifyCellChanged(TileIndex cell);
+
+    /**
+     * @brief Checks on a query without blocking
+     * @param path Receives the cells from start to goal inclusive once the status is Found
+     */
+    Status poll(Ticket ticket, std::vector<TileIndex>& path);
+
+    void cancel();
+
+private:
+    struct Request
+    {
+        std::shared_ptr<const OccupancyGrid> snapshot;
+        TileIndex start{ -1 };
+        TileIndex goal{ -1 };
+        Algorithm algorithm{ Algorithm::AStar };
+        Ticket ticket{};
+        std::vector<TileIndex> changedCells;        // Changes the snapshot includes that the worker hasn't seen
+        bool allCellsChanged{};
+        bool prepareOnly{};                         // Build the cluster graph, no search
+    };
+
+    static constexpr size_t getMaxChangedCells() { return 1 << 16; }
+
+    void run();
+    void queue(Request request);
+    bool findPath(const Request& request);
+
+    std::thread m_worker;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::atomic<bool> m_cancelRequested{ false };
+    Request m_pending;
+    std::vector<TileIndex> m_changedCells;          // Since the last submit
+    bool m_allCellsChanged{};
+    bool m_hasPending{};
+    bool m_stopping{};
+    Ticket m_nextTicket{ 1 };
+    Ticket m_resultTicket{};
+    Status m_resultStatus{ Status::Pending };
+    std::vector<TileIndex> m_resultPath;
+
+    // Only touched by the worker
+    AStarSearch m_search;
+    JumpPointSearch m_jumpPointSearch;
+    HierarchicalPathfinder m_hierarchicalPathfinder;
+    std::vector<TileIndex> m_workerPath;
+};
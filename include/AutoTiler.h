@@ -0,0 +1,81 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Direction.h"
+#include "OccupancyGrid.h"
+
+/**
+ * @brief Picks solid and border tile variants from the materials painted on a map
+ *
+ * Each cell stores a material such as "grass". The eight neighbors that share
+ * it form a bitmask, and a 256-entry table maps the mask to a border
+ * direction. A material_border_<direction> tile has its own material towards
+ * <direction> and open ground on the far side: an edge open to the south is
+ * border_north, an outer corner open to the south and west is
+ * border_northeast, and an inner corner whose only open neighbor is the
+ * south-west diagonal reuses border_northeast. Shapes with no matching
+ * variant, or variants TileRules doesn't know, fall back to the solid tile.
+ */
+class AutoTiler
+{
+public:
+    AutoTiler() = default;
+    AutoTiler(int columns, int rows);
+
+    int getColumns() const { return m_columns; }
+    int getRows() const { return m_rows; }
+
+    /**
+     * @brief Stores a material without retiling; follow bulk edits with retileAll
+     */
+    void setMaterial(int x, int y, const std::string& material);
+
+    /**
+     * @brief Picks the tile of every cell in one pass
+     */
+    void retileAll();
+
+    /**
+     * @brief Paints a material and retiles that cell and its eight neighbors
+     * @param changed Receives the cells whose tile key changed
+     */
+    void paint(int x, int y, const std::string& material, std::vector<TileIndex>& changed);
+
+    const std::string& getMaterial(int x, int y) const { return m_materials[m_cells[toIndex(x, y)]].name; }
+
+    /**
+     * @brief SpriteFactory key of a cell's tile; solid tiles are keyed by material
+     */
+    const std::string& getTileKey(int x, int y) const { return m_tileKeys[m_keys[toIndex(x, y)]]; }
+
+    /**
+     * @return Border direction of a cell's tile, or Direction::NONE for solid tiles
+     */
+    Direction::Type getBorder(int x, int y) const { return m_borders[m_keys[toIndex(x, y)]]; }
+
+private:
+    struct Material
+    {
+        std::string name;
+        std::array<int, Direction::NORTHWEST + 1> keys;     // Key per border direction, NONE is solid
+    };
+
+    TileIndex toIndex(int x, int y) const { return y * m_columns + x; }
+    int internMaterial(const std::string& material);
+    int internKey(const std::string& key, Direction::Type border);
+    int pickKey(int x, int y) const;
+    static const std::array<Direction::Type, 256>& getBorderTable();
+
+    int m_columns{};
+    int m_rows{};
+    std::vector<uint16_t> m_cells;                    // Material id per cell
+    std::vector<int> m_keys;                          // Tile key id per cell
+    std::vector<Material> m_materials;
+    std::unordered_map<std::string, int> m_materialIds;
+    std::vector<std::string> m_tileKeys;
+    std::vector<Direction::Type> m_borders;           // Border direction of each tile key
+    std::unordered_map<std::string, int> m_tileKeyIds;
+};
@@ -0,0 +1,97 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <raylib.h>
+#include "OccupancyGrid.h"
+#include "Sprite.h"
+#include "Tile.h"
+#include "TileGrid.h"
+
+/**
+ * @brief Keeps the ground and every resting sprite in a render texture
+ *
+ * Each frame sync() compares tiles and sprites with what was baked last
+ * time: a replaced tile, a new colour offset, or a sprite that moved, started
+ * or stopped walking marks the tiles under it dirty. redraw() re-renders only
+ * dirty tiles, clipped to runs of tiles along a row. Walking sprites are
+ * never baked; they are handed back to be drawn over the cache.
+ */
+class BackgroundCache
+{
+public:
+    BackgroundCache() = default;
+
+    /**
+     * @brief Allocates the cache for a board; every tile starts dirty
+     * @return false when the board is too large for one render texture
+     */
+    bool build(int columns, int rows);
+
+    /**
+     * @brief Whether a board fits in one render texture
+     */
+    static bool fits(int columns, int rows)
+    {
+        return columns > 0 && rows > 0 &&
+               columns <= getMaxTextureSize() / Tile::getSize() && rows <= getMaxTextureSize() / Tile::getSize();
+    }
+    bool isReady() const { return m_target != nullptr; }
+
+    void invalidate(TileIndex tile);
+    void invalidate(Rectangle area);
+    void invalidateAll();
+
+    /**
+     * @brief Marks tiles whose look changed since the last sync
+     * @param live Receives the sprites that must be drawn over the cache this frame
+     */
+    void sync(const TileGrid& tiles,
+              const std::vector<std::shared_ptr<Sprite>>& sprites,
+              std::vector<std::shared_ptr<Sprite>>& live);
+
+    /**
+     * @brief Re-renders the dirty tiles into the cache
+     * @param drawArea Draws the ground and the baked sprites that overlap an area; clipping is already set
+     */
+    void redraw(const std::function<void(Rectangle)>& drawArea);
+
+    /**
+     * @brief Resting sprites currently drawn into the cache
+     */
+    const std::vector<std::shared_ptr<Sprite>>& getBakedSprites() const { return m_baked; }
+
+    /**
+     * @brief Blits the cache to the screen
+     */
+    void draw() const;
+
+    int getLastRedrawCount() const { return m_lastRedrawCount; }
+    static constexpr int getMaxTextureSize() { return 8192; }
+
+private:
+    struct SpriteState
+    {
+        bool live{};
+        bool visible{};
+        Rectangle rect{};
+        Vector4 offset{};
+    };
+
+    struct TileState
+    {
+        std::shared_ptr<const Tile> tile;
+        Vector4 offset{};
+    };
+
+    int m_columns{};
+    int m_rows{};
+    std::shared_ptr<const RenderTexture2D> m_target;
+    std::vector<TileState> m_tiles;
+    std::unordered_map<const Sprite*, SpriteState> m_sprites;
+    std::vector<std::shared_ptr<Sprite>> m_baked;
+    std::vector<uint8_t> m_dirty;                   // One flag per tile
+    std::vector<TileIndex> m_dirtyTiles;
+    int m_lastRedrawCount{};
+};
@@ -0,0 +1,136 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+/**
+ * @brief Packed one-bit-per-cell board mask with multiword rows
+ *
+ * Every row starts on a fresh 64-bit word, so row scans and shifts never have
+ * to straddle two rows. Bits past the last column are always zero.
+ */
+class BitGrid
+{
+public:
+    BitGrid() = default;
+    BitGrid(int columns, int rows)
+        : m_columns(columns),
+          m_rows(rows),
+          m_wordsPerRow((columns + 63) / 64),
+          m_words(static_cast<size_t>(m_wordsPerRow) * rows, 0) {}
+
+    int getColumns() const { return m_columns; }
+    int getRows() const { return m_rows; }
+    int getWordsPerRow() const { return m_wordsPerRow; }
+
+    bool test(int x, int y) const { return (m_words[y * m_wordsPerRow + (x >> 6)] >> (x & 63)) & 1; }
+
+    void set(int x, int y, bool value)
+    {
+        uint64_t& word = m_words[y * m_wordsPerRow + (x >> 6)];
+        const uint64_t bit = uint64_t{ 1 } << (x & 63);
+        word = value ? (word | bit) : (word & ~bit);
+    }
+
+    void clear() { std::fill(m_words.begin(), m_words.end(), 0); }
+
+    const uint64_t* getRow(int y) const { return &m_words[static_cast<size_t>(y) * m_wordsPerRow]; }
+    uint64_t* getRow(int y) { return &m_words[static_cast<size_t>(y) * m_wordsPerRow]; }
+    const std::vector<uint64_t>& getWords() const { return m_words; }
+    std::vector<uint64_t>& getWords() { return m_words; }
+
+    /**
+     * @brief Mask of the valid bits in a word of a row; padding bits are zero
+     */
+    uint64_t getColumnMask(int word) const
+    {
+        const int remaining = m_columns - word * 64;
+        return remaining >= 64 ? ~uint64_t{ 0 } : (uint64_t{ 1 } << remaining) - 1;
+    }
+
+    /**
+     * @return First set bit at or after x in row y, or getColumns() if there is none
+     */
+    int findNextSet(int y, int x) const
+    {
+        if (x >= m_columns)
+            return m_columns;
+        const uint64_t* row = getRow(y);
+        int word = x >> 6;
+        uint64_t bits = row[word] & (~uint64_t{ 0 } << (x & 63));
+        while (true)
+        {
+            if (bits)
+                return word * 64 + countTrailingZeros(bits);
+            if (++word >= m_wordsPerRow)
+                return m_columns;
+            bits = row[word];
+        }
+    }
+
+    /**
+     * @return Last set bit at or before x in row y, or -1 if there is none
+     */
+    int findPreviousSet(int y, int x) const
+    {
+        if (x < 0)
+            return -1;
+        const uint64_t* row = getRow(y);
+        int word = x >> 6;
+        uint64_t bits = row[word] & lowMask(x & 63);
+        while (true)
+        {
+            if (bits)
+                return word * 64 + 63 - countLeadingZeros(bits);
+            if (--word < 0)
+                return -1;
+            bits = row[word];
+        }
+    }
+
+    /**
+     * @return Bits 0..bit inclusive
+     */
+    static uint64_t lowMask(int bit) { return bit >= 63 ? ~uint64_t{ 0 } : (uint64_t{ 1 } << (bit + 1)) - 1; }
+
+    static int countTrailingZeros(uint64_t value)
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctzll(value);
+#endif
+    }
+
+    static int countSetBits(uint64_t value)
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        return static_cast<int>(__popcnt64(value));
+#else
+        return __builtin_popcountll(value);
+#endif
+    }
+
+    static int countLeadingZeros(uint64_t value)
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return 63 - static_cast<int>(index);
+#else
+        return __builtin_clzll(value);
+#endif
+    }
+
+private:
+    int m_columns{};
+    int m_rows{};
+    int m_wordsPerRow{};
+    std::vector<uint64_t> m_words;
+};
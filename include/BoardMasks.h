@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "BitGrid.h"
+
+/**
+ * @brief Packed wall, occupancy and goal masks of a board
+ *
+ * Occupancy is also kept transposed, so a column of the board is a row of
+ * that mask and vertical slides scan words just like horizontal ones.
+ */
+class BoardMasks
+{
+public:
+    BoardMasks() = default;
+    BoardMasks(int columns, int rows)
+        : m_walls(columns, rows),
+          m_occupied(columns, rows),
+          m_occupiedColumns(rows, columns),
+          m_goals(columns, rows) {}
+
+    int getColumns() const { return m_occupied.getColumns(); }
+    int getRows() const { return m_occupied.getRows(); }
+
+    void setWall(int x, int y, bool value) { m_walls.set(x, y, value); }
+    void setGoal(int x, int y, bool value) { m_goals.set(x, y, value); }
+    void setOccupied(int x, int y, bool value)
+    {
+        m_occupied.set(x, y, value);
+        m_occupiedColumns.set(y, x, value);
+    }
+
+    bool isWall(int x, int y) const { return m_walls.test(x, y); }
+    bool isGoal(int x, int y) const { return m_goals.test(x, y); }
+    bool isOccupied(int x, int y) const { return m_occupied.test(x, y); }
+
+    const BitGrid& getWalls() const { return m_walls; }
+    const BitGrid& getOccupied() const { return m_occupied; }
+    const BitGrid& getGoals() const { return m_goals; }
+
+    /**
+     * @brief Number of free cells an object at (x, y) slides over before it hits something
+     */
+    int getSlideDistance(int x, int y, int dirX, int dirY) const;
+
+    /**
+     * @brief True when every goal cell is occupied
+     */
+    bool isSolved() const;
+
+    /**
+     * @brief Marks every free cell reachable from (x, y) in 4-connected steps
+     *
+     * Rows are filled a word at a time with carry arithmetic and then spread to
+     * the rows above and below, revisiting only rows next to one that changed.
+     * The start cell itself may be occupied.
+     */
+    void fillReachable(int x, int y, BitGrid& reached) const;
+
+private:
+    /**
+     * @return Nonzero if any bit of the row was added
+     */
+    uint64_t fillRow(uint64_t* reached, const uint64_t* open) const;
+
+    BitGrid m_walls;                // Immovable objects
+    BitGrid m_occupied;             // Any residing sprite, walls included
+    BitGrid m_occupiedColumns;      // m_occupied transposed
+    BitGrid m_goals;
+    // Scratch for fillReachable
+    mutable std::vector<uint64_t> m_rowOpen;
+    mutable std::vector<int> m_pendingRows;
+    mutable std::vector<char> m_rowQueued;
+};
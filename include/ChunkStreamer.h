@@ -0,0 +1,155 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "BitGrid.h"
+#include "Direction.h"
+#include "MappedFile.h"
+
+/**
+ * @brief Pages square chunks of a memory-mapped level file in and out
+ *
+ * Opening the file makes one pass over it: it records where every chunk
+ * starts on each matrix row, and fills one-bit-per-cell summaries of goals,
+ * immovable objects and movable objects. Those summaries are all the board
+ * needs for occupancy and pathfinding, so the keys of a chunk are only parsed
+ * when the chunk is wanted. Its tiles are auto-tiled as they are parsed, from
+ * a one-cell ring read out of the neighboring chunks. Parsing runs on a worker
+ * thread, and resident chunks are evicted least recently wanted first once
+ * they exceed the budget. Pinned chunks, whose contents changed since they
+ * were read, are never evicted.
+ */
+class ChunkStreamer
+{
+public:
+    /**
+     * @brief Keys of one chunk, row-major within the chunk; tile keys are already auto-tiled
+     */
+    struct ChunkData
+    {
+        int chunk{};
+        int left{};
+        int top{};
+        int width{};
+        int height{};
+        std::vector<std::string> tileKeys;
+        std::vector<Direction::Type> borders;       // Border direction of each tile, NONE for solid tiles
+        std::vector<std::string> immovableKeys;
+        std::vector<std::string> movableKeys;
+        std::vector<char> goals;
+
+        int toSlot(int x, int y) const { return (y - top) * width + (x - left); }
+    };
+
+    /**
+     * @param maxColumns Widest level accepted; the header is checked before anything is sized from it
+     * @param maxRows Tallest level accepted
+     */
+    ChunkStreamer(const std::string& path, int chunkSize, int maxColumns, int maxRows);
+    ~ChunkStreamer();
+    ChunkStreamer(const ChunkStreamer&) = delete;
+    ChunkStreamer& operator=(const ChunkStreamer&) = delete;
+
+    int getRows() const { return m_rows; }
+    int getColumns() const { return m_columns; }
+    int getChunkSize() const { return m_chunkSize; }
+    int getChunkColumns() const { return m_chunkColumns; }
+    int getChunkCount() const { return m_chunkColumns * m_chunkRows; }
+    int toChunk(int x, int y) const { return (y / m_chunkSize) * m_chunkColumns + x / m_chunkSize; }
+
+    const BitGrid& getGoals() const { return m_goals; }
+    const BitGrid& getImmovables() const { return m_immovables; }
+    const BitGrid& getMovables() const { return m_movables; }
+
+    /**
+     * @brief Parses a chunk on the calling thread, for chunks needed before the worker gets to them
+     */
+    std::shared_ptr<const ChunkData> read(int chunk) const;
+
+    /**
+     * @brief Queues the wanted chunks that aren't resident, hands back parsed ones and picks evictions
+     * @param wanted Chunks to keep or load, most important first; they are never evicted this call
+     * @param ready Receives parsed chunks, now counted as resident; materialize them
+     * @param evicted Receives resident chunks to drop
+     */
+    void update(const std::vector<int>& wanted,
+                std::vector<std::shared_ptr<const ChunkData>>& ready,
+                std::vector<int>& evicted);
+
+    /**
+     * @brief Counts a chunk loaded through read() as resident
+     */
+    void markResident(int chunk);
+    bool isResident(int chunk) const { return m_resident[chunk] != 0; }
+
+    /**
+     * @brief Keeps a resident chunk loaded for good; its contents no longer match the file
+     */
+    void pin(int chunk);
+
+    /**
+     * @brief Most unpinned chunks kept resident, as long as they aren't wanted
+     */
+    void setChunkBudget(int chunks) { m_chunkBudget = chunks; }
+    int getChunkBudget() const { return m_chunkBudget; }
+    int getResidentCount() const { return m_residentCount; }
+
+    /**
+     * @brief True while requested chunks are queued or being parsed
+     */
+    bool isLoading() const;
+
+private:
+    enum Matrix
+    {
+        TILES,
+        IMMOVABLES,
+        MOVABLES,
+        MATRIX_COUNT
+    };
+
+    void index(int maxColumns, int maxRows);
+    size_t indexMatrix(size_t position, Matrix matrix);
+    void parseRow(Matrix matrix, int y, int left, int right, std::string* keys) const;
+    void run();
+
+    MappedFile m_file;
+    int m_rows{};
+    int m_columns{};
+    int m_chunkSize{};
+    int m_chunkColumns{};
+    int m_chunkRows{};
+    std::vector<uint64_t> m_rowStarts;            // [matrix][row] offset of each row in the file
+    std::vector<uint32_t> m_chunkOffsets;         // [matrix][row][chunk column] offset of the chunk within its row
+    BitGrid m_goals;
+    BitGrid m_immovables;
+    BitGrid m_movables;
+
+    // Owned by the calling thread
+    std::vector<char> m_resident;
+    std::vector<char> m_pinned;
+    std::vector<char> m_requested;                // Queued or being parsed
+    std::list<int> m_lru;                         // Unpinned resident chunks, most recently wanted first
+    std::vector<std::list<int>::iterator> m_lruPositions;
+    std::vector<uint64_t> m_lastWanted;           // Update that last wanted each chunk
+    uint64_t m_updateCount{};
+    int m_residentCount{};
+    int m_chunkBudget{ 256 };
+
+    // Shared with the worker
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<int> m_queue;
+    std::vector<std::shared_ptr<const ChunkData>> m_done;
+    int m_parsing{ -1 };
+    bool m_stopping{};
+    std::thread m_worker;
+};
@@ -0,0 +1,125 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+#include "OccupancyGrid.h"
+#include "PagedArray.h"
+
+/**
+ * @brief Windowed cooperative A* (WHCA*) for many agents sharing one board
+ *
+ * Every agent plans a short space-time route that avoids the cells other
+ * agents have reserved for the same time steps. Routes only cover a window
+ * of steps and are refreshed halfway through, and only a fixed number of
+ * agents replan per frame, so planning cost per frame stays bounded no
+ * matter how many agents there are.
+ *
+ * Agent cells are expected to be marked blocked in the grid; the planner
+ * treats them as free space and resolves agents through reservations.
+ */
+class CooperativePlanner
+{
+public:
+    using AgentId = int;
+
+    struct Move
+    {
+        AgentId agent;
+        TileIndex from;
+        TileIndex to;
+    };
+
+    explicit CooperativePlanner(int window = 16, int replansPerFrame = 32, int maxExpansions = 1024)
+        : m_window(window), m_replansPerFrame(replansPerFrame), m_maxExpansions(maxExpansions) {}
+
+    AgentId addAgent(const OccupancyGrid& grid, TileIndex position, TileIndex goal);
+    void setGoal(AgentId agent, TileIndex goal);
+    TileIndex getPosition(AgentId agent) const { return m_agents[agent].position; }
+    TileIndex getGoal(AgentId agent) const { return m_agents[agent].goal; }
+    int getAgentCount() const { return static_cast<int>(m_agents.size()); }
+
+    /**
+     * @brief Moves an agent that was displaced by something other than the planner
+     */
+    void relocate(AgentId agent, TileIndex position);
+
+    /**
+     * @brief Tells the planner that a non-agent cell changed its blocked state
+     */
+    void notifyCellChanged();
+
+    /**
+     * @brief Replans up to the per-frame budget of agents that need it
+     */
+    void plan(const OccupancyGrid& grid);
+
+    /**
+     * @brief Advances every agent one time step along its reserved route
+     * Agents whose next cell is blocked or still taken wait and replan instead.
+     * @return Moves that were made this step
+     */
+    const std::vector<Move>& advance(const OccupancyGrid& grid);
+
+private:
+    struct Agent
+    {
+        TileIndex position;
+        TileIndex goal;
+        std::vector<TileIndex> route;               // route[i] is the cell at tick routeTick + i
+        int64_t routeTick{};
+        bool queued{};
+    };
+
+    struct Node
+    {
+        int64_t key{ -1 };                          // cell * (window + 1) + step, -1 when empty
+        int g{};
+        int parent{ -1 };                           // Slot of the parent node
+        bool closed{};
+        uint32_t generation{};
+    };
+
+    struct OpenEntry
+    {
+        int f;
+        int h;
+        int slot;
+        bool operator<(const OpenEntry& other) const { return f != other.f ? f > other.f : h > other.h; }
+    };
+
+    bool isStaticBlocked(const OccupancyGrid& grid, TileIndex cell) const;
+    bool hasGoalDistances(const OccupancyGrid& grid, TileIndex goal) const;
+    const PagedArray<int>& getGoalDistances(const OccupancyGrid& grid, TileIndex goal);
+    void planAgent(const OccupancyGrid& grid, AgentId agent);
+    void queueReplan(AgentId agent);
+    void reserve(AgentId agent);
+    void unreserve(AgentId agent);
+    bool isReserved(TileIndex cell, int64_t tick, AgentId agent) const;
+    TileIndex getPlannedCell(const Agent& agent, int64_t tick) const;
+    int findSlot(int64_t key);
+
+    static uint64_t toReservationKey(TileIndex cell, int64_t tick)
+    {
+        return (static_cast<uint64_t>(tick) << 32) | static_cast<uint32_t>(cell);
+    }
+
+    int m_window;
+    int m_replansPerFrame;
+    int m_maxExpansions;
+    int64_t m_tick{};
+    uint32_t m_staticVersion{};
+    std::vector<Agent> m_agents;
+    PagedArray<AgentId> m_agentAt;                  // Agent standing on each cell, or -1
+    std::deque<AgentId> m_replanQueue;
+    std::unordered_map<uint64_t, AgentId> m_reservations;
+    std::unordered_map<TileIndex, std::pair<uint32_t, PagedArray<int>>> m_goalDistances;
+    std::vector<Move> m_moves;
+    std::vector<Move> m_pending;
+
+    // Scratch for the space-time search, reused between agents
+    std::vector<Node> m_nodes;
+    std::vector<OpenEntry> m_open;
+    std::vector<TileIndex> m_queue;
+    uint32_t m_generation{};
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include <climits>
+#include <utility>
+#include <vector>
+#include "IndexHeap.h"
+#include "OccupancyGrid.h"
+#include "PagedArray.h"
+
+/**
+ * @brief Incremental D* Lite planner for one agent walking towards a fixed goal
+ *
+ * The search runs backwards from the goal and keeps its g/rhs values between
+ * queries. When a cell changes its blocked state only the inconsistent part of
+ * the search is repaired, and moving the start costs no search at all.
+ */
+class DStarLite
+{
+public:
+    static constexpr int INF = INT_MAX / 4;
+
+    void initialize(const OccupancyGrid& grid, TileIndex start, TileIndex goal);
+    void reset() { m_goal = -1; m_open.clear(); }
+    bool isActive() const { return m_goal >= 0; }
+    TileIndex getStart() const { return m_start; }
+    TileIndex getGoal() const { return m_goal; }
+
+    /**
+     * @brief Moves the search start, e.g. after the agent stepped onto a new tile
+     */
+    void updateStart(const OccupancyGrid& grid, TileIndex start);
+
+    /**
+     * @brief Repairs the search around a cell whose blocked state changed
+     */
+    void notifyCellChanged(const OccupancyGrid& grid, TileIndex cell);
+
+    /**
+     * @brief Brings the search up to date
+     * @return Whether the goal is reachable from the start
+     */
+    bool computeShortestPath(const OccupancyGrid& grid);
+
+    /**
+     * @brief Follows the g-values from start to goal
+     * @param path Receives the cells from start to goal inclusive; cleared if unreachable
+     */
+    bool extractPath(const OccupancyGrid& grid, std::vector<TileIndex>& path) const;
+
+private:
+    using Key = std::pair<int, int>;
+
+    Key calculateKey(const OccupancyGrid& grid, TileIndex cell) const;
+    void updateVertex(const OccupancyGrid& grid, TileIndex cell);
+    int getCost(const OccupancyGrid& grid, TileIndex from, TileIndex to) const;
+
+    PagedArray<int> m_g;                          // Paged, so cells the search never reaches cost nothing
+    PagedArray<int> m_rhs;
+    IndexHeap<Key> m_open;
+    TileIndex m_start{ -1 };
+    TileIndex m_goal{ -1 };
+    TileIndex m_lastStart{ -1 };
+    int m_keyModifier{};
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include <vector>
+#include "BitGrid.h"
+#include "BoardMasks.h"
+#include "OccupancyGrid.h"
+
+/**
+ * @brief Detects board states from which the goals can no longer all be filled
+ *
+ * The static table marks dead cells: cells from which an object can't slide
+ * onto any goal even in the best case, where the player can stand anywhere
+ * that isn't a wall and other objects can serve as stoppers. The dynamic
+ * check finds frozen objects, i.e. objects that can't be pushed in any direction
+ * because walls and other frozen objects block both sides. A state is deadlocked
+ * when the objects that can still reach goals are fewer than the goals nothing
+ * permanent covers.
+ */
+class DeadlockDetector
+{
+public:
+    struct Scratch
+    {
+        BitGrid frozen;             // Frozen objects found by the last check
+        BitGrid blocked;
+    };
+
+    /**
+     * @brief Builds the dead cell table from the walls and goals of a level
+     * @param objectCount Number of movable objects; with one object only walls stop a slide
+     */
+    void build(const BoardMasks& masks, int objectCount);
+
+    bool isBuilt() const { return m_live.getColumns() > 0; }
+    bool isDeadCell(int x, int y) const { return isBuilt() && !m_live.test(x, y); }
+
+    /**
+     * @brief Checks a state, taking objects to be the occupied cells that aren't walls
+     * @return False until the dead cell table is built
+     */
+    bool isDeadlocked(const BoardMasks& masks, Scratch& scratch) const;
+
+private:
+    bool canPushFrom(const BitGrid& blocked, int x, int y, int dirX, int dirY) const;
+
+    BitGrid m_live;                 // Cells from which some sequence of slides reaches a goal
+};
@@ -0,0 +1,42 @@
+#pragma once
+#include <vector>
+#include "OccupancyGrid.h"
+#include "PagedArray.h"
+
+/**
+ * @brief Breadth-first distance and next-step field rooted at one cell
+ *
+ * One build answers "how far is every tile from the root" and "which way
+ * back to the root" for the whole board, so repeated path queries from the
+ * same root only walk the field. Storage is paged, so walled-off parts of the
+ * board cost nothing; a flood still pays for the area it reaches.
+ */
+class DistanceField
+{
+public:
+    void build(const OccupancyGrid& grid, TileIndex root);
+    void invalidate() { m_valid = false; }
+    bool isValidFor(TileIndex root) const { return m_valid && m_root == root; }
+    TileIndex getRoot() const { return m_root; }
+
+    bool isReachable(TileIndex cell) const { return m_distances.get(cell) >= 0; }
+    int getDistance(TileIndex cell) const { return m_distances.get(cell); }
+
+    /**
+     * @return Neighbor one step closer to the root, or -1 for the root and unreachable cells
+     */
+    TileIndex getNextStep(TileIndex cell) const { return m_nextSteps.get(cell); }
+
+    /**
+     * @brief Walks the field from a target back to the root
+     * @param path Receives the cells from root to target inclusive; cleared if unreachable
+     */
+    bool getPathFromRoot(TileIndex target, std::vector<TileIndex>& path) const;
+
+private:
+    PagedArray<int> m_distances;
+    PagedArray<TileIndex> m_nextSteps;
+    std::vector<TileIndex> m_queue;
+    TileIndex m_root{ -1 };
+    bool m_valid{};
+};
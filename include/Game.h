@@ -7,11 +7,13 @@
 #include <memory>
 #include <raylib.h>
 #include "GameBoard.h"
+#include "BackgroundCache.h"
+#include "TilemapLayer.h"
 
 class Game final
 {
 public:
-    Game(const std::string& path, const std::string& playerName);
+    Game(const std::string& path, const std::string& playerName, GameBoard::LoadMode mode = GameBoard::LoadMode::InMemory);
     ~Game() = default;
     void run();
     void handleLeftMouseButtonClick(const Vector2& mousePosition);
@@ -19,10 +21,32 @@ public:
     void update(double deltaTime);
     void handleInputEvents();
 
+    /**
+     * @brief Opt-in: skip frames while nothing changes and sleep until the next input event
+     */
+    void setEventDriven(bool eventDriven) { m_eventDriven = eventDriven; }
+
 private:
+    bool hasActivity() const;
+    bool handleCamera();
+    void updateGround();
+    void drawGround(const TileRange& range);
+    void drawVisible();
+
     GameState m_gameState;
     GameBoard m_gameBoard;
+    Camera2D m_camera{ {}, {}, 0.0f, 1.0f };
     Renderer m_renderer;
-    std::vector<std::shared_ptr<Sprite>> m_backgroundSprites;
+    TilemapLayer m_tilemap;                       // Ground in one draw call, when the tiles allow it
+    bool m_useTilemap{};
+    BackgroundCache m_background;                 // Ground and resting sprites, re-rendered per dirty tile
     std::vector<std::shared_ptr<Sprite>> m_foregroundSprites;
+    std::vector<std::shared_ptr<Sprite>> m_liveSprites;   // Walking sprites drawn over the cache
+    std::vector<std::shared_ptr<Sprite>> m_visibleSprites;
+    bool m_eventDriven{};
+    double m_stepStart{};                         // GetTime() when the current step began
+    double m_deltaTime{};                         // Seconds the current step advances by
+    bool m_firstFrame{ true };
+    bool m_inputChanged{};                        // Click or a new hovered tile this frame
+    int m_hoveredTile{ -1 };
 };
@@ -15,31 +15,151 @@
 #include "Sprite.h"
 #include "Player.h"
 #include "Tile.h"
+#include "TileGrid.h"
+#include "ZobristTable.h"
+#include "OccupancyGrid.h"
+#include "AutoTiler.h"
+#include "BoardMasks.h"
+#include "ChunkStreamer.h"
+#include "SpatialHash.h"
+#include "AsyncPathfinder.h"
+#include "CooperativePlanner.h"
+#include "DStarLite.h"
+#include "DeadlockDetector.h"
+#include "DistanceField.h"
+#include "LevelData.h"
 
 class GameBoard
 {
 public:
+    using PathMode = AsyncPathfinder::Algorithm;
+
+    enum class LoadMode
+    {
+        InMemory,           // Parse the whole level up front
+        Streamed            // Map the file and load chunks around the camera and agents
+    };
+
     GameBoard() = default;
-    GameBoard(const std::string& path, const std::string& playerName);
+    GameBoard(const std::string& path, const std::string& playerName, LoadMode mode = LoadMode::InMemory);
     void update(const GameState& state);
     void onClick(const GameState& state);
     void pushObject(const std::shared_ptr<Sprite>& object, const std::shared_ptr<Sprite>& player);
-    void readDimensions(const std::string& path);
+    void readDimensions(const LevelData& level);
     std::shared_ptr<Sprite> getPlayer() const;
-    std::shared_ptr<Tile> getTile(int x, int y) const;
-    std::shared_ptr<Tile> getClosestAvailableTile(const std::shared_ptr<Tile>& start, const std::shared_ptr<Tile>& destination) const;
+    const std::shared_ptr<Tile>& getTile(int x, int y) const;
+    const std::shared_ptr<Tile>& getTile(TileIndex index) const;
+    TileHandle getClosestAvailableTile(TileHandle start, TileHandle destination) const;
     std::vector<std::shared_ptr<Sprite>> getResidingSprites() const;
-    std::vector<std::shared_ptr<Tile>> getTiles() const;
-    std::vector<std::shared_ptr<Tile>> getPathToTile(const std::shared_ptr<Tile>& startTile, const std::shared_ptr<Tile>& goalTile) const;
-    std::shared_ptr<Tile> getEnclosingTile(const std::shared_ptr<Sprite>& sprite) const;
-    std::shared_ptr<Tile> getEnclosingTile(Vector2 windowCoordinates) const;
-    bool isSolved();
+
+    /**
+     * @brief Chunked tile storage; chunks nobody has used yet hold no tiles
+     */
+    const TileGrid& getTileGrid() const { return m_tiles; }
+
+    /**
+     * @brief Creates the tiles of every chunk overlapping a range, e.g. before drawing it
+     */
+    void loadTiles(const TileRange& range) const;
+
+    /**
+     * @brief Streams chunks in around a view and the agents, and evicts the least recently wanted
+     *
+     * Does nothing unless the board was opened with LoadMode::Streamed.
+     */
+    void updateStreaming(const TileRange& view);
+
+    /**
+     * @brief Memory that unpinned streamed chunks may hold; chunks in use are kept regardless
+     */
+    void setStreamingBudget(size_t bytes);
+    bool isStreamed() const { return m_streamer != nullptr; }
+    bool isReachable(TileIndex startTile, TileIndex goalTile) const;
+    const BoardMasks& getMasks() const { return m_masks; }
+
+    /**
+     * @brief Search that click queries run on the worker
+     */
+    void setPathMode(PathMode mode) { m_pathMode = mode; }
+    PathMode getPathMode() const { return m_pathMode; }
+    const std::vector<TileIndex>& getPathPreview() const;
+    const DistanceField& getPlayerField() const;
+    std::shared_ptr<const OccupancyGrid> getOccupancySnapshot() const;
+    void setResidingSprite(TileIndex index, const std::shared_ptr<Sprite>& sprite);
+
+    /**
+     * @brief Paints a material on a cell and re-tiles only that cell and its neighbors
+     */
+    void paintTile(int x, int y, const std::string& material);
+    const AutoTiler& getAutoTiler() const { return m_autoTiler; }
+
+    /**
+     * @brief Hands a sprite residing on the board to the cooperative planner
+     * @return Id used to retarget the agent later
+     */
+    CooperativePlanner::AgentId addAgent(const std::shared_ptr<Sprite>& sprite, TileIndex goal);
+    void setAgentGoal(CooperativePlanner::AgentId agent, TileIndex goal);
+    TileHandle getEnclosingTile(const std::shared_ptr<Sprite>& sprite) const;
+    TileHandle getEnclosingTile(Vector2 windowCoordinates) const;
+
+    /**
+     * @brief Picks the tile under a screen position seen through a camera
+     * @return Invalid handle when the position is off the board
+     */
+    TileHandle getEnclosingTile(Vector2 screenCoordinates, const Camera2D& camera) const;
+
+    /**
+     * @brief Tiles a camera can see on a screen of the given size, clamped to the board
+     */
+    TileRange getVisibleTiles(const Camera2D& camera, int screenWidth, int screenHeight) const;
+
+    /**
+     * @brief Appends the sprites residing on a range of tiles; the board itself is the spatial index
+     */
+    void collectResidingSprites(const TileRange& range, std::vector<std::shared_ptr<Sprite>>& sprites) const;
+
+    /**
+     * @brief Bounds of every sprite on the board, including the player and walking sprites, in world coordinates
+     */
+    const SpatialHash& getSpriteIndex() const { return m_spriteIndex; }
+    bool isSolved() const { return m_unfilledGoals == 0; }
+
+    /**
+     * @brief True while anything on the board will change without new input
+     *
+     * Covers a queued path query, a walking player, a pending replan and
+     * agents that haven't reached their goals.
+     */
+    bool isBusy() const;
+
+    /**
+     * @brief Hash of the occupied cells and the player's tile, updated as the board changes
+     */
+    uint64_t getStateHash() const;
+    int getUnfilledGoalCount() const { return m_unfilledGoals; }
+
+    /**
+     * @brief True once a push left the board in a state that can't be solved
+     */
+    bool isDeadlocked() const { return m_deadlocked; }
+    const DeadlockDetector& getDeadlockDetector() const { return m_deadlocks; }
     int generateRandomRotation(int x, int y) const;
     int getBoardRows() const { return m_boardRows; }
     int getBoardColumns() const { return m_boardColumns; }
     Vector2 getBoardBounds() const { return m_boardBounds; }
-    static constexpr int getMaxRows() { return 7; }
-    static constexpr int getMaxColumns() { return 7; }
+    static constexpr int getMaxRows() { return 4096; }
+    static constexpr int getMaxColumns() { return 4096; }
+
+    /**
+     * @brief Largest board that previews the route to the hovered tile; the preview floods the whole board
+     */
+    static constexpr int getMaxPreviewCells() { return 256 * 256; }
+
+    /**
+     * @brief Largest board whose clicks search every tile; larger ones use the cluster graph
+     */
+    static constexpr int getMaxFlatPathCells() { return 256 * 256; }
+    static constexpr float getAgentStepDuration() { return 0.25f; }
 
 private:
     int m_boardRows{};
@@ -47,34 +167,55 @@ private:
     Vector2 m_boardBounds{};
     std::shared_ptr<Sprite> m_hoveredSprite{};
     std::shared_ptr<Sprite> m_player{};
-    std::vector<std::vector<std::shared_ptr<Tile>>> m_tiles;
+    mutable TileGrid m_tiles;                     // Chunks are created on first access, even through const lookups
+    AutoTiler m_autoTiler;                        // Material painted on each cell and the tile it shows
+    std::vector<TileIndex> m_retiledCells;        // Scratch for paintTile
+    OccupancyGrid m_occupancy;
+    BoardMasks m_masks;
+    mutable BitGrid m_reachable;                  // Scratch for isReachable
+    ZobristTable m_zobrist;
+    uint64_t m_occupancyHash{};                   // XOR of the keys of all occupied cells
+    int m_unfilledGoals{};
+    DeadlockDetector m_deadlocks;                 // Dead cells of this level and the frozen-object check
+    DeadlockDetector::Scratch m_deadlockScratch;
+    bool m_deadlocked{};
+    PathMode m_pathMode{ PathMode::AStar };
+    DStarLite m_playerPlanner;                    // Keeps the player's route valid while the board changes
+    TileIndex m_playerTile{ -1 };
+    bool m_replanPending{};
+    std::unique_ptr<AsyncPathfinder> m_asyncPathfinder;
+    AsyncPathfinder::Ticket m_pathTicket{};       // In-flight click query, 0 when idle
+    TileIndex m_pendingGoal{ -1 };
+    std::shared_ptr<const OccupancyGrid> m_pendingSnapshot;
+    mutable std::shared_ptr<const OccupancyGrid> m_snapshot;  // Shared until the occupancy changes
+    mutable DistanceField m_playerField;          // Rebuilt when the player's tile or the occupancy changes
+    CooperativePlanner m_agentPlanner;            // Moves autonomous sprites without collisions
+    std::vector<std::shared_ptr<Sprite>> m_agents;
+    float m_agentStepTimer{};
+    bool m_movingAgents{};                        // Agent moves don't change the planner's static map
+    std::vector<TileIndex> m_path;
+    std::vector<TileIndex> m_pathPreview;         // Route from the player to the hovered tile
+    std::vector<Vector2> m_pathCoordinates;
     std::vector<std::shared_ptr<Sprite>> m_residingSprites;
+    std::unique_ptr<ChunkStreamer> m_streamer;    // Only set for streamed boards
+    std::vector<int> m_wantedChunks;
+    std::vector<std::shared_ptr<const ChunkStreamer::ChunkData>> m_readyChunks;
+    std::vector<int> m_evictedChunks;
+    std::vector<std::shared_ptr<Sprite>> m_evictedSprites;
+    mutable SpatialHash m_spriteIndex{ static_cast<float>(Tile::getSize()) };   // Streamed chunks add sprites from const lookups
 
-    struct AStarNode
-    {
-        AStarNode(std::shared_ptr<Tile> tile, std::shared_ptr<AStarNode> parent, float gCost, float hCost)
-            : m_tile(std::move(tile)),
-            m_parent(std::move(parent)),
-            m_gValue(gCost),
-            m_hValue(hCost) {}
-
-        float getFValue() const { return m_gValue + m_hValue; }
-        float getGValue() const { return m_gValue; }
-        float getHValue() const { return m_hValue; }
-        std::shared_ptr<Tile> getCorrespondingTile() { return m_tile; }
-        std::shared_ptr<AStarNode> getParent() { return m_parent; }
-        bool operator>(const AStarNode& other) const { return getFValue() > other.getFValue(); }
-
-    private:
-        std::shared_ptr<Tile> m_tile;
-        std::shared_ptr<AStarNode> m_parent;
-        float m_gValue;
-        float m_hValue;
-    };
-
-    using Matrix = std::vector<std::vector<std::string>>;
-    static Matrix loadMatrix(const std::string& path, int offset, int expectedRows, int expectedColumns);
-    static std::vector<std::shared_ptr<Tile>> reversePath(const std::shared_ptr<AStarNode>& node);
-    static float heuristic(const std::shared_ptr<Tile>& first, const std::shared_ptr<Tile> second);
-    std::vector<std::shared_ptr<Tile>> getNeighborTiles(const std::shared_ptr<Tile>& tile) const;
+    int getNeighborTiles(TileIndex tile, std::array<TileIndex, 4>& neighbors) const;
+    void allocateGrids();
+    void openLevel(const LevelData& level);
+    void openStreamed(const std::string& path);
+    void setDimensions(int rows, int columns);
+    void loadStreamedChunk(const ChunkStreamer::ChunkData& data) const;
+    void setBlocked(TileIndex index, bool blocked);
+    std::shared_ptr<Tile> createTile(int x, int y) const;
+    std::shared_ptr<Tile> createTile(int x, int y, const std::string& key, Direction::Type border) const;
+    void walkPlayerPath(const std::vector<TileIndex>& path);
+    void updatePlayerPlan();
+    void startPlayerRoute(TileIndex goal, bool stale);
+    void pollPathRequest();
+    void updateAgents(float deltaTime);
 };
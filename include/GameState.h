@@ -4,6 +4,7 @@
 struct GameState
 {
 	GameState() = default;
-	Vector2 mousePosition{};
+	Vector2 mousePosition{};                        // Screen coordinates
 	float deltaTime{};
+	Camera2D camera{ {}, {}, 0.0f, 1.0f };          // View the board is drawn through
 };
@@ -0,0 +1,137 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "IndexHeap.h"
+#include "OccupancyGrid.h"
+
+/**
+ * @brief HPA*-style pathfinder over fixed-size clusters of the board
+ *
+ * Every pair of neighboring clusters is linked through entrance cells, one per
+ * open stretch of their shared border, and each cluster caches the distances
+ * between its own entrances. Queries search this small abstract graph and
+ * refine only the chosen hops back to tiles. Occupancy changes mark just the
+ * touched cluster (and the neighbor across the border) for rebuilding.
+ */
+class HierarchicalPathfinder
+{
+public:
+    explicit HierarchicalPathfinder(int clusterSize = 16) : m_clusterSize(clusterSize) {}
+
+    int getClusterSize() const { return m_clusterSize; }
+
+    /**
+     * @brief Marks the clusters whose entrances or distances depend on a cell as stale
+     */
+    void invalidate(const OccupancyGrid& grid, TileIndex cell);
+
+    /**
+     * @brief Marks every cluster as stale, e.g. when too many changes went untracked
+     */
+    void invalidateAll();
+
+    /**
+     * @brief Rebuilds stale clusters and their connectivity now rather than on the next query
+     */
+    void prepare(const OccupancyGrid& grid);
+
+    /**
+     * @brief Finds a near-optimal path between two open cells
+     * @param path Receives the cells from start to goal inclusive; cleared on failure
+     * @return Whether the goal is reachable
+     */
+    bool findPath(const OccupancyGrid& grid, TileIndex start, TileIndex goal, std::vector<TileIndex>& path);
+
+private:
+    static constexpr int INF = 1 << 29;
+
+    struct Entrance
+    {
+        TileIndex cell;
+        std::array<TileIndex, 2> partners;          // Cells across the border, one per side the cell touches
+        int partnerCount;
+        int component{};                            // Entrances that can reach each other share a component
+        int node{ -1 };                             // Abstract search node, valid when generation matches
+        uint32_t generation{};
+    };
+
+    struct Cluster
+    {
+        int x0{};
+        int y0{};
+        int width{};
+        int height{};
+        std::vector<Entrance> entrances;
+        std::vector<int> distances;                 // entrances x entrances, INF when disconnected
+        bool dirty{ true };
+    };
+
+    struct Key
+    {
+        int f;
+        int h;
+        bool operator<(const Key& other) const { return f != other.f ? f < other.f : h < other.h; }
+    };
+
+    struct Node
+    {
+        TileIndex cell;
+        int gScore;
+        int parent;                                 // Node id of the parent, -1 for the start
+        int slot;                                   // Slot in its cluster's entrance list, -1 if not an entrance
+        bool closed;
+    };
+
+    void layout(const OccupancyGrid& grid);
+    void refresh(const OccupancyGrid& grid);
+    void markDirty(int cluster);
+    void buildEntrances(const OccupancyGrid& grid, int cluster);
+    void addBorderEntrances(const OccupancyGrid& grid, int cluster, int dx, int dy);
+    void buildDistances(const OccupancyGrid& grid, int cluster);
+    void buildComponents(const OccupancyGrid& grid);
+    int findRoot(int entrance);
+    bool canConnect(const Cluster& startCluster, const Cluster& goalCluster) const;
+    int getClusterOf(const OccupancyGrid& grid, TileIndex cell) const;
+    static int findEntrance(const Cluster& cluster, TileIndex cell);
+    void loadCluster(const OccupancyGrid& grid, const Cluster& cluster);
+    void searchCluster(const OccupancyGrid& grid, TileIndex source);
+    int toLocal(const OccupancyGrid& grid, TileIndex cell) const;
+    int getLocalDistance(const OccupancyGrid& grid, TileIndex cell) const;
+    bool appendLocalPath(const OccupancyGrid& grid, TileIndex from, TileIndex to, std::vector<TileIndex>& path);
+    int addNode(TileIndex cell, int slot);
+    int getEntranceNode(int cluster, int slot);
+    int getNode(const OccupancyGrid& grid, TileIndex cell);
+    void relax(int from, int to, int cost, int goalH);
+
+    int m_clusterSize;
+    int m_columns{};
+    int m_rows{};
+    int m_clustersX{};
+    int m_clustersY{};
+    std::vector<Cluster> m_clusters;
+    std::vector<int> m_dirtyClusters;
+    std::vector<int> m_componentParents;            // Union-find over entrances numbered across all clusters
+    bool m_componentsStale{ true };                 // Set when clusters were rebuilt after the last union-find
+
+    // Scratch for breadth-first searches on a copy of one cluster padded with a blocked frame
+    std::vector<uint8_t> m_localBlocked;
+    std::vector<int> m_localDistances;
+    std::vector<int> m_localParents;
+    std::vector<int> m_localQueue;
+    int m_localX0{};
+    int m_localY0{};
+    int m_localWidth{};
+    int m_localHeight{};
+
+    // Scratch for the abstract search; nodes are numbered per query, so it grows with
+    // the entrances a query reaches rather than with the board
+    std::vector<int> m_startDistances;              // Start cluster entrance slot -> distance from start
+    std::vector<int> m_goalDistances;               // Goal cluster entrance slot -> distance to goal
+    std::vector<Node> m_nodes;
+    IndexHeap<Key> m_open;                          // Keyed by node id
+    std::vector<TileIndex> m_abstractPath;
+    uint32_t m_generation{};
+    TileIndex m_goal{ -1 };
+    int m_goalNode{ -1 };                           // Goal node when the goal is not an entrance
+};
@@ -0,0 +1,130 @@
+#pragma once
+#include <vector>
+#include "OccupancyGrid.h"
+#include "PagedArray.h"
+
+/**
+ * @brief Binary min-heap over cell indices with in-place key updates
+ *
+ * Keys live in the heap next to their index, and heap slots per cell are
+ * paged, so memory follows the cells a search queues rather than the board.
+ * Both are kept across clear(), which keeps repeated searches over the same
+ * area allocation-free.
+ */
+template <typename Key>
+class IndexHeap
+{
+public:
+    void resize(int capacity)
+    {
+        m_heap.clear();
+        m_positions.assign(capacity, -1);
+    }
+
+    void clear()
+    {
+        for (const Entry& entry : m_heap)
+            m_positions.set(entry.index, -1);
+        m_heap.clear();
+    }
+
+    bool empty() const { return m_heap.empty(); }
+    int size() const { return static_cast<int>(m_heap.size()); }
+    int capacity() const { return m_positions.size(); }
+    bool contains(TileIndex index) const { return m_positions.get(index) >= 0; }
+    TileIndex top() const { return m_heap.front().index; }
+    const Key& topKey() const { return m_heap.front().key; }
+
+    /**
+     * @brief Inserts an index or moves it to its new key if already queued
+     */
+    void push(TileIndex index, const Key& key)
+    {
+        int position = m_positions.get(index);
+        if (position < 0)
+        {
+            position = static_cast<int>(m_heap.size());
+            m_heap.push_back({ key, index });
+            siftUp(position);
+            return;
+        }
+        m_heap[position].key = key;
+        siftUp(position);
+        siftDown(m_positions.get(index));
+    }
+
+    TileIndex pop()
+    {
+        TileIndex index = m_heap.front().index;
+        removeAt(0);
+        return index;
+    }
+
+    void remove(TileIndex index)
+    {
+        int position = m_positions.get(index);
+        if (position >= 0)
+            removeAt(position);
+    }
+
+private:
+    struct Entry
+    {
+        Key key;
+        TileIndex index;
+    };
+
+    void removeAt(int position)
+    {
+        TileIndex removed = m_heap[position].index;
+        Entry last = m_heap.back();
+        m_heap.pop_back();
+        m_positions.set(removed, -1);
+        if (position == static_cast<int>(m_heap.size()))
+            return;
+
+        m_heap[position] = last;
+        siftUp(position);
+        siftDown(m_positions.get(last.index));
+    }
+
+    void siftUp(int position)
+    {
+        Entry entry = m_heap[position];
+        while (position > 0)
+        {
+            int parent = (position - 1) / 2;
+            if (!(entry.key < m_heap[parent].key))
+                break;
+            m_heap[position] = m_heap[parent];
+            m_positions.set(m_heap[position].index, position);
+            position = parent;
+        }
+        m_heap[position] = entry;
+        m_positions.set(entry.index, position);
+    }
+
+    void siftDown(int position)
+    {
+        const int count = static_cast<int>(m_heap.size());
+        Entry entry = m_heap[position];
+        while (true)
+        {
+            int child = 2 * position + 1;
+            if (child >= count)
+                break;
+            if (child + 1 < count && m_heap[child + 1].key < m_heap[child].key)
+                ++child;
+            if (!(m_heap[child].key < entry.key))
+                break;
+            m_heap[position] = m_heap[child];
+            m_positions.set(m_heap[position].index, position);
+            position = child;
+        }
+        m_heap[position] = entry;
+        m_positions.set(entry.index, position);
+    }
+
+    std::vector<Entry> m_heap;
+    PagedArray<int> m_positions;                  // Heap slot of every index, -1 when not queued
+};
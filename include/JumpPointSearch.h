@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "IndexHeap.h"
+#include "OccupancyGrid.h"
+#include "PagedArray.h"
+
+/**
+ * @brief Jump Point Search for uniform-cost 4-connected boards
+ *
+ * Paths are kept in a canonical form (vertical runs that may branch into
+ * horizontal runs), so only jump points where that form has to turn are put
+ * on the open list. Horizontal runs are scanned 64 cells at a time on the
+ * packed blocked bitmap of the board. Returned paths have the same length
+ * as plain A*.
+ */
+class JumpPointSearch
+{
+public:
+    /**
+     * @brief Finds a shortest path between two cells
+     * @param path Receives the cells from start to goal inclusive; cleared on failure
+     * @return Whether the goal is reachable
+     */
+    bool findPath(const OccupancyGrid& grid, TileIndex start, TileIndex goal, std::vector<TileIndex>& path);
+
+    int getExpandedCount() const { return m_expandedCount; }
+
+private:
+    struct Key
+    {
+        int f;
+        int h;
+        bool operator<(const Key& other) const { return f != other.f ? f < other.f : h < other.h; }
+    };
+
+    struct Node
+    {
+        int gScore;
+        TileIndex parent;
+        uint32_t seenGeneration;
+        uint32_t closedGeneration;
+        int8_t directionX;                          // Direction of the jump that reached the cell
+        int8_t directionY;
+    };
+
+    bool isOpen(const OccupancyGrid& grid, int x, int y) const;
+    int jumpHorizontal(const OccupancyGrid& grid, int x, int y, int dx) const;
+    int jumpVertical(const OccupancyGrid& grid, int x, int y, int dy) const;
+    void push(const OccupancyGrid& grid, TileIndex from, TileIndex to, int dx, int dy);
+    void beginQuery(int size);
+
+    PagedArray<Node> m_nodes;                       // Paged, so only the area a query reaches is allocated
+    IndexHeap<Key> m_open;
+    uint32_t m_generation{};
+    int m_expandedCount{};
+    int m_goalX{};
+    int m_goalY{};
+    TileIndex m_goal{ -1 };
+};
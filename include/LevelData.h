@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Raw contents of a level file, independent of any rendering
+ *
+ * A level file holds a "rows,columns" line followed by three CSV matrices of
+ * texture keys: tiles, immovable objects and movable objects. Object cells
+ * without a sprite read "Empty". A tile key prefixed with '*' marks a goal
+ * tile; the marker is stripped from the stored key.
+ *
+ * Keys are interned: every cell holds a small id into one table of distinct
+ * keys, so a large level costs two bytes per cell per matrix.
+ */
+class LevelData
+{
+public:
+    LevelData() : LevelData(0, 0) {}
+    LevelData(int rows, int columns);
+
+    /**
+     * @brief Reads a level file in a single pass over a memory mapping of it
+     */
+    static LevelData load(const std::string& path);
+
+    /**
+     * @brief Parses level text; errors name the source, line and column
+     * @param name Source named in error messages, usually the path
+     */
+    static LevelData parse(std::string_view text, const std::string& name);
+
+    /**
+     * @brief Writes the level in the same format load reads
+     */
+    void save(const std::string& path) const;
+    void write(std::ostream& stream) const;
+
+    int getRows() const { return m_rows; }
+    int getColumns() const { return m_columns; }
+    bool contains(int x, int y) const { return x >= 0 && y >= 0 && x < m_columns && y < m_rows; }
+
+    const std::string& getTileKey(int x, int y) const { return m_keys[m_tileKeys[toIndex(x, y)]]; }
+    const std::string& getImmovableKey(int x, int y) const { return m_keys[m_immovableKeys[toIndex(x, y)]]; }
+    const std::string& getMovableKey(int x, int y) const { return m_keys[m_movableKeys[toIndex(x, y)]]; }
+    bool isGoal(int x, int y) const { return m_goals[toIndex(x, y)] != 0; }
+    bool hasImmovable(int x, int y) const { return m_immovableKeys[toIndex(x, y)] != getEmptyKeyId(); }
+    bool hasMovable(int x, int y) const { return m_movableKeys[toIndex(x, y)] != getEmptyKeyId(); }
+
+    int getTileKeyId(int x, int y) const { return m_tileKeys[toIndex(x, y)]; }
+    int getImmovableKeyId(int x, int y) const { return m_immovableKeys[toIndex(x, y)]; }
+    int getMovableKeyId(int x, int y) const { return m_movableKeys[toIndex(x, y)]; }
+    const std::string& getKey(int id) const { return m_keys[id]; }
+    int getKeyCount() const { return static_cast<int>(m_keys.size()); }
+
+    void setTileKey(int x, int y, const std::string& key) { m_tileKeys[toIndex(x, y)] = internKey(key); }
+    void setImmovableKey(int x, int y, const std::string& key) { m_immovableKeys[toIndex(x, y)] = internKey(key); }
+    void setMovableKey(int x, int y, const std::string& key) { m_movableKeys[toIndex(x, y)] = internKey(key); }
+    void setGoal(int x, int y, bool goal) { m_goals[toIndex(x, y)] = goal ? 1 : 0; }
+
+    static const char* getEmptyKey() { return "Empty"; }
+    static constexpr int getEmptyKeyId() { return 1; }        // Interned right after the blank tile key
+    static constexpr char getGoalMarker() { return '*'; }
+
+private:
+    int toIndex(int x, int y) const { return y * m_columns + x; }
+    uint16_t internKey(std::string_view key);
+
+    int m_rows{};
+    int m_columns{};
+    std::vector<uint16_t> m_tileKeys;             // Key id per cell, row-major like every board grid
+    std::vector<uint16_t> m_immovableKeys;
+    std::vector<uint16_t> m_movableKeys;
+    std::vector<char> m_goals;
+    std::vector<std::string> m_keys;
+    std::unordered_map<std::string, uint16_t> m_keyIds;
+};
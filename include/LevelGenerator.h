@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "BoardMasks.h"
+#include "LevelData.h"
+#include "OccupancyGrid.h"
+#include "TerrainGenerator.h"
+
+/**
+ * @brief Produces solvable levels by playing pushes backwards from a solved board
+ *
+ * Every object starts on a goal. Each step pulls an object back along a
+ * slide it could have made, from a cell the player can reach, so replaying
+ * the steps forwards always solves the level. Candidates are scored by their
+ * optimal solution length and by how many pushes are available along the
+ * way.
+ */
+class LevelGenerator
+{
+public:
+    struct Settings
+    {
+        int rows{ 7 };
+        int columns{ 7 };
+        int objectCount{ 3 };
+        float wallDensity{ 0.15f };
+        int reverseMoves{ 60 };           // Upper bound on pulls per candidate
+        bool verify{ true };              // Run PuzzleSolver for the optimal length
+        std::string tileKey{ "grass" };
+        std::string wallKey{ "rock" };
+        std::string objectKey{ "rock" };
+        std::vector<std::string> terrainTiles;  // Tile stems for TerrainGenerator; empty paints tileKey everywhere
+    };
+
+    struct Candidate
+    {
+        LevelData level;
+        uint64_t seed{};
+        int depth{};                      // Pulls played back from the solved board
+        int solutionLength{};             // Optimal pushes, or depth when not verified
+        double branching{};               // Average pushes available per state on the way
+        double score{};
+    };
+
+    explicit LevelGenerator(const Settings& settings);
+
+    /**
+     * @brief Generates one candidate; the same seed always gives the same level
+     * @return Candidate with depth 0 when no usable level came out of this seed
+     */
+    Candidate generate(uint64_t seed) const;
+
+    /**
+     * @brief Generates candidates for consecutive seeds on a thread pool
+     * @return Usable candidates, best score first
+     */
+    std::vector<Candidate> generateMany(int count, uint64_t firstSeed, int threadCount = 0) const;
+
+private:
+    struct Pull
+    {
+        int object;
+        TileIndex to;
+        TileIndex pusher;
+    };
+
+    void collectPulls(const BoardMasks& masks, const std::vector<TileIndex>& objects,
+                      const BitGrid& reached, std::vector<Pull>& pulls) const;
+    int countPushes(const BoardMasks& masks, const std::vector<TileIndex>& objects, const BitGrid& reached) const;
+
+    Settings m_settings;
+    std::shared_ptr<const TerrainGenerator> m_terrain;
+};
@@ -0,0 +1,150 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LEVEL_TEXT_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+/**
+ * @brief Scanning helpers shared by the level readers
+ *
+ * Level files are CSV, so finding the next delimiter is most of the work.
+ * With SSE2 it is done 16 bytes at a time; without it, byte by byte.
+ */
+namespace LevelText
+{
+    inline bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+    inline std::string_view trim(const char* begin, const char* end)
+    {
+        while (begin < end && isBlank(*begin))
+            ++begin;
+        while (end > begin && isBlank(end[-1]))
+            --end;
+        return { begin, static_cast<size_t>(end - begin) };
+    }
+
+    /**
+     * @return End of the line starting at begin, excluding the newline
+     */
+    inline const char* findLineEnd(const char* begin, const char* end)
+    {
+        const void* newline = std::memchr(begin, '\n', static_cast<size_t>(end - begin));
+        return newline ? static_cast<const char*>(newline) : end;
+    }
+
+    /**
+     * @return First comma or newline at or after begin, or end
+     */
+    inline const char* findDelimiter(const char* begin, const char* end)
+    {
+#ifdef LEVEL_TEXT_SSE2
+        const __m128i comma = _mm_set1_epi8(',');
+        const __m128i newline = _mm_set1_epi8('\n');
+        while (end - begin >= 16)
+        {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+            const int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, comma), _mm_cmpeq_epi8(block, newline)));
+            if (mask != 0)
+            {
+#if defined(_MSC_VER) && !defined(__clang__)
+                unsigned long index;
+                _BitScanForward(&index, static_cast<unsigned long>(mask));
+                return begin + index;
+#else
+                return begin + __builtin_ctz(static_cast<unsigned>(mask));
+#endif
+            }
+            begin += 16;
+        }
+#endif
+        while (begin < end && *begin != ',' && *begin != '\n')
+            ++begin;
+        return begin;
+    }
+
+    /**
+     * @brief Finds delimiters through a whole buffer, 64 bytes at a time
+     *
+     * Each block is turned into a bitmask of its commas and newlines once, so
+     * stepping from cell to cell costs a bit scan rather than a fresh search.
+     * Positions passed to next() may jump ahead but never go back.
+     */
+    class DelimiterScanner
+    {
+    public:
+        DelimiterScanner(const char* begin, const char* end) : m_block(begin), m_end(end) { load(); }
+
+        /**
+         * @return First comma or newline at or after from, or the end of the buffer
+         */
+        const char* next(const char* from)
+        {
+            while (true)
+            {
+                const ptrdiff_t offset = from - m_block;
+                if (offset < 64)
+                {
+                    const uint64_t mask = offset > 0 ? m_mask & (~uint64_t{ 0 } << offset) : m_mask;
+                    if (mask != 0)
+                        return m_block + countTrailingZeros(mask);
+                    from = m_block + 64;
+                }
+                if (from >= m_end)
+                    return m_end;
+                m_block = from;
+                load();
+            }
+        }
+
+    private:
+        void load()
+        {
+            const ptrdiff_t size = m_end - m_block;
+            m_mask = 0;
+#ifdef LEVEL_TEXT_SSE2
+            if (size >= 64)
+            {
+                const __m128i comma = _mm_set1_epi8(',');
+                const __m128i newline = _mm_set1_epi8('\n');
+                for (int i = 0; i < 4; ++i)
+                {
+                    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_block + i * 16));
+                    const uint64_t bits = static_cast<uint32_t>(_mm_movemask_epi8(
+                        _mm_or_si128(_mm_cmpeq_epi8(block, comma), _mm_cmpeq_epi8(block, newline))));
+                    m_mask |= bits << (i * 16);
+                }
+                return;
+            }
+#endif
+            for (ptrdiff_t i = 0; i < size && i < 64; ++i)
+            {
+                if (m_block[i] == ',' || m_block[i] == '\n')
+                    m_mask |= uint64_t{ 1 } << i;
+            }
+        }
+
+        static int countTrailingZeros(uint64_t value)
+        {
+#if defined(_MSC_VER) && !defined(__clang__)
+            unsigned long index;
+            _BitScanForward64(&index, value);
+            return static_cast<int>(index);
+#else
+            return __builtin_ctzll(value);
+#endif
+        }
+
+        const char* m_block;                        // Start of the block m_mask describes
+        const char* m_end;
+        uint64_t m_mask{};
+    };
+}
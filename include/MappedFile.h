@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Read-only memory mapping of a whole file
+ *
+ * Pages are brought in by the OS as they are touched, so a large level costs
+ * address space rather than memory. The mapping may be read from any thread.
+ */
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    const char* getData() const { return m_data; }
+    size_t getSize() const { return m_size; }
+    std::string_view getView() const { return { m_data, m_size }; }
+    bool isOpen() const { return m_data != nullptr; }
+
+private:
+    void close();
+
+    const char* m_data{};
+    size_t m_size{};
+#ifdef _WIN32
+    void* m_file{};
+    void* m_mapping{};
+#endif
+};
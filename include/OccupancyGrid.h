@@ -0,0 +1,78 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include "BitGrid.h"
+
+using TileIndex = int;
+
+/**
+ * @brief Per-cell blocked flags of a board, stored row-major
+ *
+ * This is the only view of the board the path searches read, so it stays
+ * free of sprites and can be copied cheaply.
+ */
+class OccupancyGrid
+{
+public:
+    OccupancyGrid() = default;
+    OccupancyGrid(int columns, int rows)
+        : m_columns(columns),
+          m_rows(rows),
+          m_blocked((static_cast<size_t>(columns) * rows + 63) / 64, 0),
+          m_blockedBits(columns, rows) {}
+
+    int getColumns() const { return m_columns; }
+    int getRows() const { return m_rows; }
+    int getSize() const { return m_columns * m_rows; }
+    bool contains(int x, int y) const { return x >= 0 && y >= 0 && x < m_columns && y < m_rows; }
+    TileIndex toIndex(int x, int y) const { return y * m_columns + x; }
+    int getX(TileIndex index) const { return index % m_columns; }
+    int getY(TileIndex index) const { return index / m_columns; }
+
+    bool isBlocked(TileIndex index) const { return (m_blocked[index >> 6] >> (index & 63)) & 1; }
+    void setBlocked(TileIndex index, bool blocked)
+    {
+        uint64_t& word = m_blocked[index >> 6];
+        const uint64_t bit = uint64_t{ 1 } << (index & 63);
+        word = blocked ? (word | bit) : (word & ~bit);
+        m_blockedBits.set(getX(index), getY(index), blocked);
+    }
+
+    /**
+     * @brief Same flags with every row starting on a fresh word, for word-at-a-time row scans
+     */
+    const BitGrid& getBlockedBits() const { return m_blockedBits; }
+
+    int getDistance(TileIndex first, TileIndex second) const
+    {
+        return std::abs(getX(first) - getX(second)) + std::abs(getY(first) - getY(second));
+    }
+
+    /**
+     * @brief Collects the in-bounds 4-connected neighbors of a cell, blocked or not
+     * @return Number of neighbors written to the front of the array
+     */
+    int getNeighbors(TileIndex index, std::array<TileIndex, 4>& neighbors) const
+    {
+        const int x = getX(index);
+        const int y = getY(index);
+        int count = 0;
+        if (y > 0)
+            neighbors[count++] = index - m_columns;
+        if (x > 0)
+            neighbors[count++] = index - 1;
+        if (x < m_columns - 1)
+            neighbors[count++] = index + 1;
+        if (y < m_rows - 1)
+            neighbors[count++] = index + m_columns;
+        return count;
+    }
+
+private:
+    int m_columns{};
+    int m_rows{};
+    std::vector<uint64_t> m_blocked;              // One bit per cell by index, for point tests
+    BitGrid m_blockedBits;
+};
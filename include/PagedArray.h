@@ -0,0 +1,80 @@
+#pragma once
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Cell-indexed array whose storage is allocated a page at a time on first write
+ *
+ * Pages never written all share one read-only page of the fill value, so a
+ * search that only touches part of a large board only pays for the rows it
+ * visits, and reads stay a plain double lookup. Pages hold 1024 cells; the
+ * page table costs one pointer per page.
+ */
+template <typename T>
+class PagedArray
+{
+public:
+    static constexpr int getPageBits() { return 10; }
+    static constexpr int getPageSize() { return 1 << getPageBits(); }
+
+    /**
+     * @brief Sets the size and resets every cell to the fill value
+     *
+     * Pages already allocated for the same size are refilled rather than
+     * released, so rebuilding over the same area does not allocate again.
+     */
+    void assign(int size, const T& fill)
+    {
+        if (!m_fillPage)
+            m_fillPage = std::make_unique<T[]>(getPageSize());
+        std::fill(m_fillPage.get(), m_fillPage.get() + getPageSize(), fill);
+
+        if (size == m_size && !m_pages.empty())
+        {
+            for (std::unique_ptr<T[]>& page : m_storage)
+                std::fill(page.get(), page.get() + getPageSize(), fill);
+            return;
+        }
+
+        m_size = size;
+        m_storage.clear();
+        m_pages.assign((static_cast<size_t>(size) + getPageSize() - 1) >> getPageBits(), m_fillPage.get());
+    }
+
+    /**
+     * @brief Releases every page; all cells read as the fill value again
+     */
+    void clear()
+    {
+        m_storage.clear();
+        std::fill(m_pages.begin(), m_pages.end(), m_fillPage.get());
+    }
+
+    int size() const { return m_size; }
+    int getPageCount() const { return static_cast<int>(m_storage.size()); }
+
+    const T& get(int index) const { return m_pages[index >> getPageBits()][index & (getPageSize() - 1)]; }
+    void set(int index, const T& value) { edit(index) = value; }
+
+    /**
+     * @brief Writable reference to a cell, allocating its page if needed
+     */
+    T& edit(int index)
+    {
+        T*& page = m_pages[index >> getPageBits()];
+        if (page == m_fillPage.get())
+        {
+            m_storage.push_back(std::make_unique<T[]>(getPageSize()));
+            page = m_storage.back().get();
+            std::copy(m_fillPage.get(), m_fillPage.get() + getPageSize(), page);
+        }
+        return page[index & (getPageSize() - 1)];
+    }
+
+private:
+    std::vector<T*> m_pages;                      // Every entry is either an owned page or the fill page
+    std::vector<std::unique_ptr<T[]>> m_storage;
+    std::unique_ptr<T[]> m_fillPage;
+    int m_size{};
+};
@@ -0,0 +1,95 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "BoardMasks.h"
+#include "DeadlockDetector.h"
+#include "LevelData.h"
+#include "OccupancyGrid.h"
+#include "ZobristTable.h"
+
+/**
+ * @brief Headless solver that finds the fewest pushes that solve a level
+ *
+ * Moves follow GameBoard::pushObject: the player stands next to an object,
+ * possibly diagonally, and the object slides away from the player until it
+ * hits something. Walking is free, so a state is the object positions plus
+ * the region the player can reach, named by its first cell.
+ *
+ * Pushes all cost one, so the search expands states breadth-first one depth
+ * at a time, which makes the first solved state an optimal one. Each depth
+ * is split across worker threads that steal ranges of states from each
+ * other, and duplicates are filtered through a shared lock-free table of
+ * state hashes. Pushes into a deadlock are never queued.
+ */
+class PuzzleSolver
+{
+public:
+    struct Result
+    {
+        bool solved{};
+        int length{ -1 };                 // Number of pushes in an optimal solution
+        uint64_t nodes{};                 // States expanded
+        double seconds{};
+        double nodesPerSecond{};
+        size_t peakMemory{};              // Bytes held by the table and the state layers at their peak
+        bool tableFull{};                 // Search gave up because the table ran out of slots
+    };
+
+    explicit PuzzleSolver(const LevelData& level, TileIndex playerStart = 0);
+
+    void setThreadCount(int threadCount) { m_threadCount = threadCount; }
+    void setTableCapacity(size_t capacity) { m_tableCapacity = capacity; }
+    void setMaxDepth(int maxDepth) { m_maxDepth = maxDepth; }
+
+    Result solve();
+
+private:
+    using State = std::vector<TileIndex>;     // Sorted object cells, then the player's region
+
+    struct alignas(64) WorkRange
+    {
+        std::atomic<uint64_t> range{};        // Begin in the high half, end in the low half
+    };
+
+    struct Worker
+    {
+        BoardMasks masks;
+        BitGrid reached;                      // Player region of the state being expanded
+        BitGrid childReached;
+        DeadlockDetector::Scratch deadlockScratch;
+        std::vector<TileIndex> next;          // States found for the next depth, flattened
+        State state;
+        State child;
+        uint64_t nodes{};
+    };
+
+    bool insert(uint64_t hash);
+    uint64_t getHash(const TileIndex* state) const;
+    TileIndex getRegion(const BoardMasks& masks, TileIndex player, BitGrid& reached) const;
+    void expand(Worker& worker, const TileIndex* state);
+    void runWorker(int id, const std::vector<TileIndex>& layer);
+    void addChild(Worker& worker, int moved, TileIndex target, TileIndex player);
+    bool takeWork(int id, size_t& index);
+
+    static uint64_t packRange(uint32_t begin, uint32_t end) { return (static_cast<uint64_t>(begin) << 32) | end; }
+
+    BoardMasks m_masks;                       // Walls and goals; objects are added per state
+    DeadlockDetector m_deadlocks;             // Prunes pushes that leave a goal unfillable
+    ZobristTable m_zobrist;
+    State m_start;
+    int m_objectCount{};
+    int m_stride{};
+    int m_threadCount{};
+    int m_maxDepth{ 1000 };
+    size_t m_tableCapacity{ size_t{ 1 } << 22 };
+
+    std::unique_ptr<std::atomic<uint64_t>[]> m_table;
+    size_t m_tableMask{};
+    std::atomic<size_t> m_tableCount{};
+    std::atomic<bool> m_tableFull{};
+    std::atomic<bool> m_solved{};
+    std::vector<Worker> m_workers;
+    std::unique_ptr<WorkRange[]> m_ranges;
+};
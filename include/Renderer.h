@@ -1,8 +1,19 @@
+#pragma once
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include "Sprite.h"
 #include <raylib.h>
 
+/**
+ * @brief Queues sprite draws for a frame and submits them in as few batches as possible
+ *
+ * Draws are sorted by layer, then shader, then texture. raylib only flushes
+ * its vertex batch when the shader or texture changes, so atlas sprites that
+ * share the one sprite shader go out together. The modifier colour offset
+ * rides along as vertex colour instead of a uniform, so it never splits a
+ * batch.
+ */
 class Renderer
 {
 public:
@@ -17,54 +28,43 @@ public:
         EndDrawing();
     }
 
-    // Renders all sprites in a layer
-    static void renderAll(const std::vector<std::shared_ptr<Sprite>>& sprites)
+    /**
+     * @brief Queues every visible sprite of a layer; lower layers are drawn first
+     */
+    template <typename SpriteType>
+    void submitAll(const std::vector<std::shared_ptr<SpriteType>>& sprites, int layer)
     {
         for (const auto& sprite : sprites)
-            render(sprite);
+            submit(*sprite, layer);
     }
+    void submit(const Sprite& sprite, int layer);
 
-    // Render a single sprite
-    static void render(const std::shared_ptr<Sprite>& sprite)
-    {
-        if (!sprite->getRenderFlag())
-            return;
+    /**
+     * @brief Draws everything queued since the last flush and empties the queue
+     */
+    void flush();
 
-        Rectangle spriteRect = sprite->getRect(); // Source rectangle from sprite
-        Vector2 spriteCenter = { spriteRect.width / 2.0f, spriteRect.height / 2.0f };
+    /**
+     * @return Shader and texture runs in the last flush, an upper bound on its draw calls
+     */
+    int getBatchCount() const { return m_batchCount; }
+    int getSpriteCount() const { return m_spriteCount; }
 
-        if (sprite->getRotation() != 0.0f)
-        {
-            // Define the destination rectangle
-            Rectangle dest = {
-                spriteRect.x + spriteCenter.x,  // Center of the sprite on screen (X)
-                spriteRect.y + spriteCenter.y,  // Center of the sprite on screen (Y)
-                spriteRect.width,               // Width
-                spriteRect.height               // Height
-            };
+private:
+    struct DrawCommand
+    {
+        uint64_t key;           // Layer, shader id and texture id, most significant first
+        uint32_t order;         // Submission order, keeps equal keys stable
+        Texture2D texture;
+        Shader shader;
+        Rectangle source;
+        Rectangle destination;
+        Vector2 origin;
+        float rotation;
+        Color tint;
+    };
 
-            BeginShaderMode(sprite->getShader());
-            DrawTexturePro(
-                sprite->getTexture(),            // Texture to draw
-                spriteRect,                      // Source rectangle
-                dest,                            // Destination rectangle
-                spriteCenter,                    // Origin of rotation (center of sprite)
-                sprite->getRotation(),           // Rotation angle
-                WHITE                            // Tint
-            );
-            EndShaderMode();
-        }
-        else
-        {
-            BeginShaderMode(sprite->getShader());
-            DrawTexture(
-                sprite->getTexture(),
-                spriteRect.x,
-                spriteRect.y,
-                WHITE
-            );
-            EndShaderMode();
-        }
-    }
+    std::vector<DrawCommand> m_commands;
+    int m_batchCount{};
+    int m_spriteCount{};
 };
-
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <raylib.h>
+
+class Sprite;
+
+/**
+ * @brief Uniform grid of sprite bounds for picking, overlap and nearest-neighbor queries
+ *
+ * A sprite is filed under every cell its bounds touch, so a query only looks
+ * at the cells it covers. Only cells that hold a sprite exist, and moving a
+ * sprite within the same cells just updates its bounds. Callers supply the
+ * bounds, so walking sprites are re-filed by whoever moves them.
+ */
+class SpatialHash
+{
+public:
+    explicit SpatialHash(float cellSize = 128.0f) : m_cellSize(cellSize) {}
+
+    /**
+     * @brief Adds a sprite, or moves it to new bounds
+     */
+    void update(const std::shared_ptr<Sprite>& sprite, Rectangle bounds);
+    void remove(const std::shared_ptr<Sprite>& sprite);
+    bool contains(const std::shared_ptr<Sprite>& sprite) const { return m_ids.count(sprite.get()) != 0; }
+    int getSize() const { return static_cast<int>(m_ids.size()); }
+    void clear();
+
+    /**
+     * @return Sprite under a point, the one whose center is nearest when several overlap; null if none
+     */
+    std::shared_ptr<Sprite> pick(Vector2 point) const;
+
+    /**
+     * @brief Appends every sprite whose bounds overlap an area
+     */
+    void query(Rectangle area, std::vector<std::shared_ptr<Sprite>>& sprites) const;
+
+    /**
+     * @brief Finds the sprites whose centers are nearest a point, searching outwards ring by ring
+     * @param sprites Receives up to count sprites, nearest first
+     */
+    void nearest(Vector2 point, int count, std::vector<std::shared_ptr<Sprite>>& sprites) const;
+
+    float getCellSize() const { return m_cellSize; }
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<Sprite> sprite;
+        Rectangle bounds{};
+        int left{};                                 // Inclusive span of cells
+        int top{};
+        int right{};
+        int bottom{};
+    };
+
+    static uint64_t toKey(int x, int y) { return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y); }
+    int toCell(float coordinate) const;
+    void link(int id);
+    void unlink(int id);
+    bool mark(int id) const;
+
+    float m_cellSize;
+    std::vector<Entry> m_entries;
+    std::vector<int> m_freeIds;
+    std::unordered_map<const Sprite*, int> m_ids;
+    std::unordered_map<uint64_t, std::vector<int>> m_cells;
+    int m_minX{ INT32_MAX };                        // Cells ever used; bounds the nearest-neighbor search
+    int m_minY{ INT32_MAX };
+    int m_maxX{ INT32_MIN };
+    int m_maxY{ INT32_MIN };
+    mutable std::vector<uint32_t> m_marks;          // Query stamp per entry, so multi-cell sprites are reported once
+    mutable uint32_t m_stamp{};
+};
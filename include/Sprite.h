@@ -3,6 +3,7 @@
 #include <raymath.h>
 #include <algorithm>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <vector>
 #include <sstream>
@@ -10,11 +11,25 @@
 #include "Modifier.h"
 #include "CoordinateTransformer.h"
 
+/**
+ * @brief The colour-offset shader shared by every sprite
+ */
+struct SpriteShader
+{
+    Shader shader{};
+};
+
+// Reference-counted entries of the SpriteFactory cache; the GPU object goes with the last handle
+using TextureHandle = std::shared_ptr<const Texture2D>;
+using ShaderHandle = std::shared_ptr<const SpriteShader>;
+
 class Sprite
 {
 public:
-    Sprite(const char* path, float speed = 0);
-    ~Sprite();
+    /**
+     * @param source Region of the texture holding this sprite's image, e.g. its atlas cell
+     */
+    Sprite(TextureHandle texture, Rectangle source, ShaderHandle shader, float speed = 0);
 
     /**
      * @brief Callback when a sprite gets clicked
@@ -45,10 +60,18 @@ public:
     void update(const GameState& state);
     float getRotation() const;
     bool getRenderFlag() const;
+    bool isMoving() const { return !m_path.empty(); }
     Rectangle getRect() const;
     Vector2 getWindowCoordinates() const;
     Texture2D getTexture() const;
-    Shader getShader() const;
+    const TextureHandle& getTextureHandle() const { return m_texture; }
+    Rectangle getSource() const { return m_source; }
+    const SpriteShader& getShader() const;
+
+    /**
+     * @brief Combined modifier offset, normalized; the renderer sends it as vertex colour
+     */
+    const Vector4& getColorOffset() const { return m_colorOffset; }
     void removeModifierByName(const std::string& name);
     void applyAllModifiers();
 
@@ -73,9 +96,10 @@ public:
 protected:
     bool m_renderFlag{};
     Rectangle m_rect{};
-    Texture2D m_texture;
-    Texture2D m_textureOriginal;                  // Used to restore a Sprite to original state
-    Shader m_shader;
+    TextureHandle m_texture;
+    TextureHandle m_textureOriginal;              // Used to restore a Sprite to original state
+    Rectangle m_source{};                         // Image region inside m_texture
+    ShaderHandle m_shader;
     Vector4 m_colorOffset{};
     std::vector<Modifier> m_modifierStack;        // Collection of active modifiers
     std::vector<Vector2> m_path;                  // Collection of points it will walk to
@@ -1,9 +1,14 @@
 #pragma once
+#include <algorithm>
 #include <memory>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include <filesystem>
+#include <raylib.h>
+#include "Sprite.h"
+#include "TextureAtlas.h"
 #include "TileRules.h"
 
 class SpriteFactory
@@ -14,9 +19,49 @@ public:
     {
         SpriteFactory& instance = getInstance();
         const std::string& texturePath = instance.getTexture(textureKey);
-        return std::make_shared<SpriteType>(texturePath.c_str(), std::forward<Args>(args)...);
+        Rectangle source{};
+        TextureHandle texture = instance.acquireImage(texturePath, source);
+        return std::make_shared<SpriteType>(std::move(texture), source, instance.acquireShader(),
+                                            std::forward<Args>(args)...);
     }
 
+    /**
+     * @brief Packs every registered image into one atlas; sprites created afterwards share it
+     *
+     * Needs a window, since the atlas is uploaded straight away.
+     */
+    static void buildAtlas()
+    {
+        SpriteFactory& instance = getInstance();
+        std::vector<std::string> paths;
+        for (const auto& [key, path] : instance.m_registry)
+        {
+            if (std::find(paths.begin(), paths.end(), path) == paths.end())
+                paths.push_back(path);
+        }
+        std::sort(paths.begin(), paths.end());
+        instance.m_atlas.build(paths);
+    }
+
+    static const TextureAtlas& getAtlas() { return getInstance().m_atlas; }
+
+    /**
+     * @brief Textures currently uploaded; one per asset however many sprites use it
+     */
+    static int getLoadedTextureCount()
+    {
+        const SpriteFactory& instance = getInstance();
+        int count = 0;
+        for (const auto& [path, texture] : instance.m_textures)
+            count += texture.expired() ? 0 : 1;
+        return count;
+    }
+
+    /**
+     * @brief Registers every sprite, and every tile with TileRules, ahead of the first create
+     */
+    static void initialize() { getInstance(); }
+
     SpriteFactory(const SpriteFactory&) = delete;
     SpriteFactory& operator=(const SpriteFactory&) = delete;
 
@@ -38,6 +83,65 @@ private:
         return it->second;
     }
 
+    /**
+     * @brief Shares the texture of an asset, uploading it on first use
+     *
+     * The cache only holds weak references and is keyed by file, so aliases such
+     * as "grass" and "grass_solid" share one upload and the texture is unloaded
+     * with its last sprite.
+     */
+    TextureHandle acquireTexture(const std::string& path)
+    {
+        std::weak_ptr<const Texture2D>& cached = m_textures[path];
+        if (TextureHandle texture = cached.lock())
+            return texture;
+
+        TextureHandle texture(new Texture2D(LoadTexture(path.c_str())), [](const Texture2D* released)
+        {
+            UnloadTexture(*released);
+            delete released;
+        });
+        cached = texture;
+        return texture;
+    }
+
+    /**
+     * @brief Atlas texture and region of an image, or its own texture when it isn't packed
+     */
+    TextureHandle acquireImage(const std::string& path, Rectangle& source)
+    {
+        if (m_atlas.contains(path))
+        {
+            source = m_atlas.getRegion(path);
+            return m_atlas.getTexture();
+        }
+
+        TextureHandle texture = acquireTexture(path);
+        source = { 0.0f, 0.0f, static_cast<float>(texture->width), static_cast<float>(texture->height) };
+        return texture;
+    }
+
+    /**
+     * @brief Shares the colour-offset shader, compiling it on first use
+     */
+    ShaderHandle acquireShader()
+    {
+        if (ShaderHandle shader = m_shader.lock())
+            return shader;
+
+        auto loaded = new SpriteShader{ LoadShader(nullptr, "resources/ColorModifier.fs") };
+        if (loaded->shader.id == 0)  // Shader loading failed
+            TraceLog(LOG_ERROR, "Failed to load shader. Defaulting to no shader.");
+
+        ShaderHandle shader(loaded, [](const SpriteShader* released)
+        {
+            UnloadShader(released->shader);
+            delete released;
+        });
+        m_shader = shader;
+        return shader;
+    }
+
     static SpriteFactory& getInstance()
     {
         static SpriteFactory instance;
@@ -72,15 +176,12 @@ private:
                     const std::string filePath = entry.path().string();
                     const std::string fileName = entry.path().stem().string(); // Remove file extension
 
-                    // Extract file name
-                    std::regex pattern(R"((\w+)_(solid)(?:_(\w+))?|(\w+)_((?!solid)\w+)_(\w+)(?:_(\w+))?)");
-                    std::smatch matches;
-                    if (!std::regex_match(fileName, matches, pattern))
-                        throw std::invalid_argument("Invalid tile sprite filename: " + filePath);
-
-                    std::string material = matches[1];
-                    std::string variant = matches[4].matched ? matches[4].str() : "";
-                    registerTexture(material, filePath);
+                    // Solid tiles are keyed by material, every tile also by its stem
+                    const auto [material, type, direction, variant] = TileRules::parseTileFilename(fileName);
+                    if (type == "solid")
+                        registerTexture(material, filePath);
+                    registerTexture(fileName, filePath);
+                    TileRules::getInstance().registerTile(fileName);
                 }
             }
         }
@@ -94,4 +195,7 @@ private:
 
     bool m_initialized = false;
     std::unordered_map<std::string, std::string> m_registry;
+    std::unordered_map<std::string, std::weak_ptr<const Texture2D>> m_textures;   // Keyed by file path
+    std::weak_ptr<const SpriteShader> m_shader;
+    TextureAtlas m_atlas;
 };
@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "LevelData.h"
+
+/**
+ * @brief Wave-function-collapse terrain built from the TileRules connection rules
+ *
+ * The compiled TileRules adjacency table is remapped once onto the
+ * generator's tiles as one compatibility bitset per tile and side. A cell's
+ * domain is a bitset of the tiles it may still take; constraints spread by
+ * OR-ing the compatibility sets of a domain and AND-ing the result into each
+ * neighbor, a word at a time. Generation only touches
+ * local scratch, so one generator can serve several threads.
+ */
+class TerrainGenerator
+{
+public:
+    /**
+     * @param tileNames Tile sprite stems such as "grass_solid" or "grass_border_north"
+     */
+    explicit TerrainGenerator(const std::vector<std::string>& tileNames);
+
+    int getTileCount() const { return static_cast<int>(m_names.size()); }
+    const std::string& getTileName(int tile) const { return m_names[tile]; }
+
+    /**
+     * @brief Texture key a level stores for a tile: its material, since the board's auto-tiler picks borders itself
+     */
+    const std::string& getTileKey(int tile) const { return m_keys[tile]; }
+
+    /**
+     * @brief Relative frequency of a tile when a cell collapses; defaults to 1
+     */
+    void setWeight(const std::string& tileName, float weight);
+
+    /**
+     * @brief Collapses a columns x rows map; the same seed always gives the same map
+     * @param tiles Receives one tile id per cell, row-major
+     * @return false when every attempt ran into a contradiction
+     */
+    bool generate(int columns, int rows, uint64_t seed, std::vector<int>& tiles) const;
+
+    /**
+     * @brief Overwrites the tile keys of a level with a generated map
+     */
+    bool fill(LevelData& level, uint64_t seed) const;
+
+    static constexpr int getMaxAttempts() { return 8; }
+
+private:
+    enum Side { NORTH, EAST, SOUTH, WEST, SIDE_COUNT };
+
+    struct Scratch;
+
+    void compile();
+    bool attempt(int columns, int rows, uint64_t seed, Scratch& scratch) const;
+    bool propagate(int columns, int rows, Scratch& scratch) const;
+    int chooseTile(const uint64_t* domain, double random) const;
+
+    const uint64_t* getCompatible(int tile, int side) const
+    {
+        return &m_compatible[(static_cast<size_t>(tile) * SIDE_COUNT + side) * m_wordsPerDomain];
+    }
+
+    std::vector<std::string> m_names;
+    std::vector<int> m_ids;                   // TileRules id of each tile
+    std::vector<std::string> m_keys;
+    std::vector<float> m_weights;
+    int m_wordsPerDomain{};
+    std::vector<uint64_t> m_compatible;       // [tile][side] -> tiles allowed on that side
+    std::vector<uint64_t> m_fullDomain;       // Every tile
+    std::vector<uint64_t> m_fullCompatible;   // [side] -> union over every tile
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <raylib.h>
+#include "Sprite.h"
+
+/**
+ * @brief Packs sprite images into one texture so sprites can share a draw batch
+ *
+ * Images are placed on shelves, tallest first, with a pixel of padding so
+ * filtering never samples a neighbor. Images that don't fit stay out of the
+ * atlas and keep their own texture.
+ */
+class TextureAtlas
+{
+public:
+    TextureAtlas() = default;
+
+    /**
+     * @brief Loads and packs the images, then uploads the atlas once
+     * @param maxSize Width and height limit of the atlas texture
+     */
+    void build(const std::vector<std::string>& paths, int maxSize = getDefaultMaxSize());
+
+    bool contains(const std::string& path) const { return m_regions.count(path) != 0; }
+
+    /**
+     * @brief Pixel rectangle of an image inside the atlas
+     */
+    Rectangle getRegion(const std::string& path) const;
+    const TextureHandle& getTexture() const { return m_texture; }
+    int getImageCount() const { return static_cast<int>(m_regions.size()); }
+
+    static constexpr int getDefaultMaxSize() { return 4096; }
+    static constexpr int getPadding() { return 1; }
+
+private:
+    TextureHandle m_texture;
+    std::unordered_map<std::string, Rectangle> m_regions;
+};
@@ -11,10 +11,12 @@
 class Tile : public Sprite
 {
 public:
-    Tile(const char* texturePath,
+    Tile(TextureHandle texture,
+         Rectangle source,
+         ShaderHandle shader,
          const std::shared_ptr<Sprite>& residingEntity = nullptr,
          bool isGoalTile = false)
-         : Sprite(texturePath), 
+         : Sprite(std::move(texture), source, std::move(shader)), 
            m_residingSprite(residingEntity),
            m_isGoalTile(isGoalTile) {}
 
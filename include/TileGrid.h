@@ -0,0 +1,242 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include "BitGrid.h"
+#include "OccupancyGrid.h"
+#include "Tile.h"
+
+/**
+ * @brief Lightweight reference to a cell of a TileGrid
+ */
+struct TileHandle
+{
+    TileIndex index{ -1 };
+    int x{};
+    int y{};
+
+    bool isValid() const { return index >= 0; }
+    bool operator==(const TileHandle& other) const { return index == other.index; }
+    bool operator!=(const TileHandle& other) const { return index != other.index; }
+};
+
+/**
+ * @brief Half-open rectangle of tile coordinates, e.g. the tiles in view
+ */
+struct TileRange
+{
+    int left{};
+    int top{};
+    int right{};
+    int bottom{};
+
+    bool isEmpty() const { return left >= right || top >= bottom; }
+    bool contains(int x, int y) const { return x >= left && y >= top && x < right && y < bottom; }
+};
+
+/**
+ * @brief Row-major tile store split into fixed-size chunks that are created on first use
+ *
+ * Cells keep their board-wide TileIndex; a chunk directory maps each index to
+ * its chunk in O(1). Chunks nobody has touched hold no tiles at all, so
+ * memory grows with the populated area rather than the board size. Each
+ * chunk also keeps a bit per cell with a residing sprite, letting range
+ * queries skip empty rows and empty chunks.
+ */
+class TileGrid
+{
+public:
+    TileGrid() = default;
+    TileGrid(int columns, int rows)
+        : m_columns(columns),
+          m_rows(rows),
+          m_chunkColumns((columns + getChunkSize() - 1) / getChunkSize()),
+          m_chunks(static_cast<size_t>(m_chunkColumns) * ((rows + getChunkSize() - 1) / getChunkSize()))
+    {
+    }
+
+    int getColumns() const { return m_columns; }
+    int getRows() const { return m_rows; }
+    int getSize() const { return m_columns * m_rows; }
+    bool contains(int x, int y) const { return x >= 0 && y >= 0 && x < m_columns && y < m_rows; }
+    TileIndex toIndex(int x, int y) const { return y * m_columns + x; }
+
+    TileHandle getHandle(TileIndex index) const { return { index, index % m_columns, index / m_columns }; }
+    TileHandle getHandle(int x, int y) const
+    {
+        if (!contains(x, y))
+            return {};
+        return { toIndex(x, y), x, y };
+    }
+
+    /**
+     * @brief Tile of a cell, or null while its chunk hasn't been created
+     */
+    const std::shared_ptr<Tile>& findTile(TileIndex index) const
+    {
+        static const std::shared_ptr<Tile> none;
+        const TileHandle handle = getHandle(index);
+        const Chunk* chunk = m_chunks[toChunk(handle.x, handle.y)].get();
+        return chunk ? chunk->tiles[toSlot(handle.x, handle.y)] : none;
+    }
+
+    /**
+     * @brief Tile of a cell, creating its whole chunk on first access
+     * @param create Called as create(x, y) for every cell of a new chunk
+     */
+    template<typename Create>
+    const std::shared_ptr<Tile>& getTile(TileIndex index, Create&& create)
+    {
+        const TileHandle handle = getHandle(index);
+        return loadChunk(handle.x, handle.y, create).tiles[toSlot(handle.x, handle.y)];
+    }
+
+    /**
+     * @brief Creates every chunk overlapping a range
+     */
+    template<typename Create>
+    void load(const TileRange& range, Create&& create)
+    {
+        const int size = getChunkSize();
+        for (int y = range.top - range.top % size; y < range.bottom; y += size)
+        {
+            for (int x = range.left - range.left % size; x < range.right; x += size)
+                loadChunk(x, y, create);
+        }
+    }
+
+    bool isLoaded(int x, int y) const { return m_chunks[toChunk(x, y)] != nullptr; }
+
+    /**
+     * @brief Drops the chunk holding a cell; its tiles are created again on next use
+     */
+    void unload(int x, int y) { m_chunks[toChunk(x, y)].reset(); }
+
+    void setTile(TileIndex index, std::shared_ptr<Tile> tile)
+    {
+        if (index < 0 || index >= getSize())
+            throw std::out_of_range("setTile: Invalid index");
+        const TileHandle handle = getHandle(index);
+        Chunk* chunk = m_chunks[toChunk(handle.x, handle.y)].get();
+        if (!chunk)
+            throw std::logic_error("setTile: Chunk not loaded");
+        chunk->tiles[toSlot(handle.x, handle.y)] = std::move(tile);
+    }
+
+    /**
+     * @brief Sets the sprite residing on a loaded tile and keeps the chunk's resident bits in step
+     */
+    void setResidingSprite(TileIndex index, const std::shared_ptr<Sprite>& sprite)
+    {
+        const TileHandle handle = getHandle(index);
+        Chunk* chunk = m_chunks[toChunk(handle.x, handle.y)].get();
+        if (!chunk)
+            throw std::logic_error("setResidingSprite: Chunk not loaded");
+        const int slot = toSlot(handle.x, handle.y);
+        chunk->tiles[slot]->setResidingSprite(sprite);
+        const uint32_t bit = uint32_t{ 1 } << (slot % getChunkSize());
+        uint32_t& row = chunk->residents[slot / getChunkSize()];
+        row = sprite ? row | bit : row & ~bit;
+    }
+
+    /**
+     * @brief Appends the residing sprites of a range, skipping chunks and rows without any
+     */
+    void collectResidingSprites(const TileRange& range, std::vector<std::shared_ptr<Sprite>>& sprites) const
+    {
+        const int size = getChunkSize();
+        for (int y = range.top; y < range.bottom; ++y)
+        {
+            for (int chunkX = range.left - range.left % size; chunkX < range.right; chunkX += size)
+            {
+                const Chunk* chunk = m_chunks[toChunk(chunkX, y)].get();
+                if (!chunk)
+                    continue;
+
+                // Mask the row down to the columns inside the range
+                const int from = std::max(range.left - chunkX, 0);
+                const int to = std::min(range.right - chunkX, size);
+                const uint64_t span = ((uint64_t{ 1 } << to) - 1) & ~((uint64_t{ 1 } << from) - 1);
+                for (uint64_t bits = chunk->residents[y % size] & span; bits; bits &= bits - 1)
+                {
+                    const int column = BitGrid::countTrailingZeros(bits);
+                    sprites.push_back(chunk->tiles[(y % size) * size + column]->getResidingSprite());
+                }
+            }
+        }
+    }
+
+    int getLoadedChunkCount() const
+    {
+        return static_cast<int>(std::count_if(m_chunks.begin(), m_chunks.end(),
+                                              [](const std::unique_ptr<Chunk>& chunk) { return chunk != nullptr; }));
+    }
+
+    /**
+     * @brief Collects the in-bounds 4-connected neighbors of a cell
+     * @return Number of neighbors written to the front of the array
+     */
+    int getNeighbors(TileIndex index, std::array<TileIndex, 4>& neighbors) const
+    {
+        const TileHandle handle = getHandle(index);
+        int count = 0;
+        if (handle.y > 0)
+            neighbors[count++] = index - m_columns;
+        if (handle.x > 0)
+            neighbors[count++] = index - 1;
+        if (handle.x < m_columns - 1)
+            neighbors[count++] = index + 1;
+        if (handle.y < m_rows - 1)
+            neighbors[count++] = index + m_columns;
+        return count;
+    }
+
+    static constexpr int getChunkSize() { return CHUNK_SIZE; }
+
+    /**
+     * @brief Rough memory held by a loaded chunk, counting each tile and its control block
+     */
+    static constexpr size_t getChunkBytes() { return sizeof(Chunk) + CHUNK_SIZE * CHUNK_SIZE * (sizeof(Tile) + 32); }
+
+private:
+    static constexpr int CHUNK_SIZE = 32;         // Chunk rows fit one resident word
+
+    struct Chunk
+    {
+        std::array<std::shared_ptr<Tile>, CHUNK_SIZE * CHUNK_SIZE> tiles;
+        std::array<uint32_t, CHUNK_SIZE> residents{};     // Bit per cell with a residing sprite, one word per row
+    };
+
+    int toChunk(int x, int y) const { return (y / getChunkSize()) * m_chunkColumns + x / getChunkSize(); }
+    static int toSlot(int x, int y) { return (y % getChunkSize()) * getChunkSize() + x % getChunkSize(); }
+
+    template<typename Create>
+    Chunk& loadChunk(int x, int y, Create& create)
+    {
+        std::unique_ptr<Chunk>& slot = m_chunks[toChunk(x, y)];
+        if (slot)
+            return *slot;
+
+        // Filled off to the side, so a create() that throws leaves no half-built chunk behind
+        auto chunk = std::make_unique<Chunk>();
+        const int left = x - x % getChunkSize();
+        const int top = y - y % getChunkSize();
+        const int right = std::min(left + getChunkSize(), m_columns);
+        const int bottom = std::min(top + getChunkSize(), m_rows);
+        for (int cellY = top; cellY < bottom; ++cellY)
+        {
+            for (int cellX = left; cellX < right; ++cellX)
+                chunk->tiles[toSlot(cellX, cellY)] = create(cellX, cellY);
+        }
+        slot = std::move(chunk);
+        return *slot;
+    }
+
+    int m_columns{};
+    int m_rows{};
+    int m_chunkColumns{};
+    std::vector<std::unique_ptr<Chunk>> m_chunks;   // Chunk directory, null until a chunk is first used
+};
@@ -1,4 +1,7 @@
 #pragma once
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
 #include <string>
 #include <vector>
 #include <regex>
@@ -20,24 +23,27 @@ public:
         return instance;
     }
 
-    std::tuple<std::string, std::string, Direction::Type, std::string>
+    static std::tuple<std::string, std::string, Direction::Type, std::string>
     parseTileFilename(const std::string& tilePath)
     {
         using namespace Direction;
-        // Parse tile filenames
-        std::regex pattern(R"((\w+)_(solid)(?:_(\w+))?|(\w+)_((?!solid)\w+)_(\w+)(?:_(\w+))?)");
+        // Parse tile filenames: material_solid[_variant] or material_type_direction[_variant]
+        static const std::regex pattern(R"(([A-Za-z0-9]+)_(solid)(?:_([A-Za-z0-9]+))?|([A-Za-z0-9]+)_((?!solid)[A-Za-z0-9]+)_([A-Za-z0-9]+)(?:_([A-Za-z0-9]+))?)");
         std::smatch matches;
 
         if (!std::regex_match(tilePath, matches, pattern)) 
             throw std::invalid_argument("Invalid tile sprite filename: " + tilePath);
 
-        std::string material = matches[0];
-        std::string type = matches[1];
+        // Solid tiles fill groups 1-3, every other type fills groups 4-7
+        const bool solid = matches[1].matched;
+        std::string material = solid ? matches[1].str() : matches[4].str();
+        std::string type = solid ? matches[2].str() : matches[5].str();
         if (type != "solid" && type != "border")
             throw std::invalid_argument("Invalid tile type: " + type);
                                              
-        std::string directionStr = matches[2].matched ? matches[2].str() : "nowhere";
-        std::string variant = matches[3].matched ? matches[3].str() : "";
+        std::string directionStr = !solid ? matches[6].str() : "none";
+        std::string variant = solid ? (matches[3].matched ? matches[3].str() : "")
+                                    : (matches[7].matched ? matches[7].str() : "");
         Type direction = stringToDirection(directionStr);
         return { material, type, direction, variant };
     }
@@ -47,6 +53,8 @@ public:
     {
         using namespace Direction;
         const auto [material, type, direction, variant] = parseTileFilename(tilePath);
+        if (m_connectionRules.count(tilePath))
+            return;
 
         // Initialize connection rules for non-solid tiles
     
@@ -78,9 +86,132 @@ public:
         }
     }
 
+    /**
+     * @brief Tiles allowed next to a tile in a primary direction
+     * @return nullptr when the tile places no constraint in that direction
+     */
+    const std::vector<std::string>* getValidNeighbors(const std::string& tilePath, Direction::Type direction) const
+    {
+        auto tile = m_connectionRules.find(tilePath);
+        if (tile == m_connectionRules.end())
+            return nullptr;
+        auto neighbors = tile->second.find(direction);
+        return neighbors == tile->second.end() ? nullptr : &neighbors->second;
+    }
+
+    /**
+     * @brief Stems of every tile sprite in a directory, sorted
+     */
+    static std::vector<std::string> listTileNames(const std::string& directory)
+    {
+        std::vector<std::string> names;
+        for (const auto& entry : std::filesystem::directory_iterator(directory))
+        {
+            if (entry.is_regular_file())
+                names.push_back(entry.path().stem().string());
+        }
+        std::sort(names.begin(), names.end());
+        return names;
+    }
+
+    /**
+     * @brief Gives a tile a dense id and builds its rules; the adjacency table is recompiled on the next query
+     * @return Id of the tile; registering a tile again returns the same id
+     */
+    int registerTile(const std::string& tileName)
+    {
+        auto it = m_tileIds.find(tileName);
+        if (it != m_tileIds.end())
+            return it->second;
+
+        buildTileRule(tileName);
+        const int tile = static_cast<int>(m_tileNames.size());
+        m_tileIds.emplace(tileName, tile);
+        m_tileNames.push_back(tileName);
+        m_dirty = true;
+        return tile;
+    }
+
+    /**
+     * @return Id of a registered tile, or -1
+     */
+    int findTile(const std::string& tileName) const
+    {
+        auto it = m_tileIds.find(tileName);
+        return it == m_tileIds.end() ? -1 : it->second;
+    }
+
+    int getTileCount() const { return static_cast<int>(m_tileNames.size()); }
+    const std::string& getTileName(int tile) const { return m_tileNames[tile]; }
+    int getWordsPerSet() const
+    {
+        compileIfDirty();
+        return m_wordsPerSet;
+    }
+
+    /**
+     * @brief Bitset over tile ids of the tiles that may sit in a direction of a tile
+     */
+    const uint64_t* getCompatible(int tile, Direction::Type direction) const
+    {
+        compileIfDirty();
+        return &m_adjacency[(static_cast<size_t>(tile) * getDirectionCount() + direction) * m_wordsPerSet];
+    }
+
+    bool isCompatible(int tile, Direction::Type direction, int neighbor) const
+    {
+        return (getCompatible(tile, direction)[neighbor >> 6] >> (neighbor & 63)) & 1;
+    }
+
+    static constexpr int getDirectionCount() { return Direction::NORTHWEST + 1; }
+
 private:
     TileRules() = default;
     ~TileRules() = default;
+
+    // Registering many tiles in a row compiles the table once, when it is first read
+    void compileIfDirty() const
+    {
+        if (!m_dirty)
+            return;
+        compile();
+        m_dirty = false;
+    }
+
+    // Two tiles may touch only if each one's rules accept the other; a direction without rules accepts anything
+    void compile() const
+    {
+        using namespace Direction;
+        const int tileCount = getTileCount();
+        m_wordsPerSet = (tileCount + 63) / 64;
+        m_adjacency.assign(static_cast<size_t>(tileCount) * getDirectionCount() * m_wordsPerSet, 0);
+
+        auto accepts = [this](int tile, Type direction, int neighbor)
+        {
+            const std::vector<std::string>* valid = getValidNeighbors(m_tileNames[tile], direction);
+            return !valid || std::find(valid->begin(), valid->end(), m_tileNames[neighbor]) != valid->end();
+        };
+
+        for (int tile = 0; tile < tileCount; ++tile)
+        {
+            for (int direction = 0; direction < getDirectionCount(); ++direction)
+            {
+                const Type type = static_cast<Type>(direction);
+                uint64_t* compatible = &m_adjacency[(static_cast<size_t>(tile) * getDirectionCount() + direction) * m_wordsPerSet];
+                for (int neighbor = 0; neighbor < tileCount; ++neighbor)
+                {
+                    if (accepts(tile, type, neighbor) && accepts(neighbor, getComplimentaryDirection(type), tile))
+                        compatible[neighbor >> 6] |= uint64_t{ 1 } << (neighbor & 63);
+                }
+            }
+        }
+    }
+
     using ValidNeighbors = std::vector<std::string>;
     std::unordered_map<std::string, std::unordered_map<Direction::Type, ValidNeighbors>> m_connectionRules;
+    std::unordered_map<std::string, int> m_tileIds;
+    std::vector<std::string> m_tileNames;           // Indexed by tile id
+    mutable int m_wordsPerSet{};
+    mutable std::vector<uint64_t> m_adjacency;      // [tile][direction][word]
+    mutable bool m_dirty{};
 };
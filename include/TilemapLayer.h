@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <raylib.h>
+#include "OccupancyGrid.h"
+#include "Sprite.h"
+#include "Tile.h"
+#include "TileGrid.h"
+
+/**
+ * @brief Draws the whole tile grid as one quad
+ *
+ * Every tile becomes one texel of a small RGBA8 index texture holding its
+ * atlas region and quarter turns. Tilemap.fs looks each fragment's tile up
+ * in the sprite atlas, so the ground costs one draw call whatever the board
+ * size. Replaced tiles only rewrite their own texels.
+ */
+class TilemapLayer
+{
+public:
+    TilemapLayer() = default;
+
+    /**
+     * @brief Uploads the index texture for a grid of tiles
+     * @return false when the tiles don't all come from one atlas, a chunk isn't loaded or the
+     *         grid is too large; draw them as sprites instead
+     */
+    bool build(const TileGrid& tiles);
+
+    /**
+     * @brief Rewrites the texels of tiles that were replaced since the last call
+     * @return false when a new tile can't be drawn by this layer; rebuild or fall back
+     */
+    bool update(const TileGrid& tiles);
+
+    void draw() const;
+    bool isReady() const { return m_indexTexture != nullptr; }
+    int getLastUploadCount() const { return m_lastUploadCount; }
+
+    static constexpr int getMaxRegions() { return 64; }
+
+    /**
+     * @brief Largest grid kept in the layer; update() scans every cell each frame
+     */
+    static constexpr int getMaxCells() { return 1024 * 1024; }
+
+    /**
+     * @brief Dirty texels above this count are uploaded with one full-texture update
+     */
+    static constexpr int getFullUploadThreshold() { return 64; }
+
+private:
+    bool encode(TileIndex cell, const std::shared_ptr<Tile>& tile);
+    int findRegion(Rectangle source);
+    void uploadRegions() const;
+
+    int m_columns{};
+    int m_rows{};
+    TextureHandle m_atlas;
+    TextureHandle m_indexTexture;
+    std::shared_ptr<const Shader> m_shader;
+    int m_atlasLocation{ -1 };
+    int m_regionsLocation{ -1 };
+    std::vector<uint32_t> m_texels;                 // RGBA8 per tile, mirrored on the GPU
+    std::vector<std::shared_ptr<const Tile>> m_cells;   // Tile each texel was written from, kept alive so addresses can't be reused
+    std::vector<Rectangle> m_regions;               // Pixel regions, indexed by the red channel
+    std::vector<TileIndex> m_dirty;
+    int m_lastUploadCount{};
+};
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include "OccupancyGrid.h"
+
+/**
+ * @brief Random 64-bit keys per cell for incremental board state hashing
+ *
+ * A state hash is the XOR of the keys of everything on the board, so a
+ * single move updates it with two XORs. Keys are computed from the cell
+ * index and a constant seed rather than stored, so the table costs nothing
+ * per cell and hashes stay stable across runs and machines.
+ */
+class ZobristTable
+{
+public:
+    ZobristTable() = default;
+    explicit ZobristTable(int cells) : m_cells(cells) {}
+
+    int getSize() const { return m_cells; }
+    uint64_t getOccupiedKey(TileIndex index) const { return mix(getSeed() + 2 * static_cast<uint64_t>(index)); }
+    uint64_t getPlayerKey(TileIndex index) const { return mix(getSeed() + 2 * static_cast<uint64_t>(index) + 1); }
+
+private:
+    static constexpr uint64_t getSeed() { return 0x5A0B21A7C0FFEE11ull; }
+
+    /**
+     * @brief SplitMix64 finalizer; spreads consecutive inputs over all 64 bits
+     */
+    static uint64_t mix(uint64_t value)
+    {
+        value *= 0x9E3779B97F4A7C15ull;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+        return value ^ (value >> 31);
+    }
+
+    int m_cells{};
+};
@@ -0,0 +1,35 @@
+#version 330
+
+// One quad covers the whole board; texture0 holds one texel per tile
+in vec2 fragTexCoord;
+in vec4 fragColor;
+
+uniform sampler2D texture0;     // R: atlas region id, G: quarter turns clockwise
+uniform sampler2D atlas;        // Sprite atlas holding every tile image
+uniform vec2 mapSize;           // Columns and rows
+uniform vec4 regions[64];       // Atlas regions, normalized x, y, width, height
+
+out vec4 finalColor;
+
+void main()
+{
+    vec2 position = fragTexCoord * mapSize;
+    vec2 cell = min(floor(position), mapSize - 1.0);
+    vec2 local = position - cell;
+
+    vec4 entry = texelFetch(texture0, ivec2(cell), 0);
+    int region = int(entry.r * 255.0 + 0.5);
+    int turns = int(entry.g * 255.0 + 0.5);
+
+    // Undo the tile's rotation to find where to sample its image
+    if (turns == 1)
+        local = vec2(local.y, 1.0 - local.x);
+    else if (turns == 2)
+        local = vec2(1.0 - local.x, 1.0 - local.y);
+    else if (turns == 3)
+        local = vec2(1.0 - local.y, local.x);
+
+    vec4 bounds = regions[region];
+    vec4 texColor = texture(atlas, bounds.xy + local * bounds.zw);
+    finalColor = clamp(texColor + fragColor, 0.0, 1.0);
+}
@@ -0,0 +1,92 @@
+#include "AStarSearch.h"
+#include <algorithm>
+#include <array>
+
+void AStarSearch::beginQuery(int size)
+{
+    if (m_nodes.size() != size)
+    {
+        m_nodes.assign(size, { 0, -1, 0, 0 });
+        m_open.resize(size);
+        m_generation = 0;
+    }
+
+    m_open.clear();
+    m_expandedCount = 0;
+
+    // Stamps are only compared for equality, so clearing them on wrap-around is enough
+    if (++m_generation == 0)
+    {
+        m_nodes.clear();
+        m_generation = 1;
+    }
+}
+
+bool AStarSearch::findPath(const OccupancyGrid& grid, TileIndex start, TileIndex goal, std::vector<TileIndex>& path)
+{
+    path.clear();
+    m_cancelled = false;
+    const int size = grid.getSize();
+    if (start < 0 || goal < 0 || start >= size || goal >= size)
+        return false;
+
+    if (grid.isBlocked(goal))
+        return false;
+
+    beginQuery(size);
+
+    Node& startNode = m_nodes.edit(start);
+    startNode.gScore = 0;
+    startNode.parent = -1;
+    startNode.seenGeneration = m_generation;
+    int startH = grid.getDistance(start, goal);
+    m_open.push(start, { startH, startH });
+
+    std::array<TileIndex, 4> neighbors;
+    while (!m_open.empty())
+    {
+        TileIndex current = m_open.pop();
+        Node& currentNode = m_nodes.edit(current);
+        currentNode.closedGeneration = m_generation;
+        ++m_expandedCount;
+
+        if ((m_expandedCount & 255) == 0 && m_cancellationFlag &&
+            m_cancellationFlag->load(std::memory_order_relaxed))
+        {
+            m_cancelled = true;
+            return false;
+        }
+
+        if (current == goal)
+        {
+            for (TileIndex index = goal; index >= 0; index = m_nodes.get(index).parent)
+                path.push_back(index);
+            std::reverse(path.begin(), path.end());
+            return true;
+        }
+
+        const int tentativeG = currentNode.gScore + 1;
+        const int count = grid.getNeighbors(current, neighbors);
+        for (int i = 0; i < count; ++i)
+        {
+            TileIndex neighbor = neighbors[i];
+            if (grid.isBlocked(neighbor))
+                continue;
+
+            const Node& seen = m_nodes.get(neighbor);
+            if (seen.closedGeneration == m_generation)
+                continue;
+
+            if (seen.seenGeneration == m_generation && tentativeG >= seen.gScore)
+                continue;
+
+            Node& node = m_nodes.edit(neighbor);
+            node.gScore = tentativeG;
+            node.parent = current;
+            node.seenGeneration = m_generation;
+            int h = grid.getDistance(neighbor, goal);
+            m_open.push(neighbor, { tentativeG + h, h });
+        }
+    }
+    return false;
+}
@@ -0,0 +1,168 @@
+#include "AsyncPathfinder.h"
+
+AsyncPathfinder::AsyncPathfinder()
+{
+    m_search.setCancellationFlag(&m_cancelRequested);
+    m_worker = std::thread(&AsyncPathfinder::run, this);
+}
+
+AsyncPathfinder::~AsyncPathfinder()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        m_cancelRequested = true;
+    }
+    m_condition.notify_one();
+    m_worker.join();
+}
+
+AsyncPathfinder::Ticket AsyncPathfinder::submit(std::shared_ptr<const OccupancyGrid> snapshot, TileIndex start, TileIndex goal,
+                                                Algorithm algorithm)
+{
+    Ticket ticket;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ticket = m_nextTicket++;
+        queue({ std::move(snapshot), start, goal, algorithm, ticket });
+        m_cancelRequested = true;                   // Abort whatever the worker is busy with
+    }
+    m_condition.notify_one();
+    return ticket;
+}
+
+void AsyncPathfinder::prepare(std::shared_ptr<const OccupancyGrid> snapshot)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_hasPending)
+            return;                                 // The queued query builds the graph anyway
+        Request request{ std::move(snapshot) };
+        request.algorithm = Algorithm::Hierarchical;
+        request.prepareOnly = true;
+        queue(std::move(request));
+    }
+    m_condition.notify_one();
+}
+
+void AsyncPathfinder::queue(Request request)
+{
+    // A superseded request never ran, so the changes it carried go with this one
+    if (m_hasPending)
+    {
+        request.changedCells.swap(m_pending.changedCells);
+        request.allCellsChanged = m_pending.allCellsChanged;
+    }
+    request.changedCells.insert(request.changedCells.end(), m_changedCells.begin(), m_changedCells.end());
+    request.allCellsChanged = request.allCellsChanged || m_allCellsChanged;
+    m_changedCells.clear();
+    m_allCellsChanged = false;
+
+    m_pending = std::move(request);
+    m_hasPending = true;
+}
+
+void AsyncPathfinder::notifyCellChanged(TileIndex cell)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_allCellsChanged)
+        return;
+
+    // Past this many changes rebuilding every cluster is cheaper than tracking them
+    if (m_changedCells.size() >= getMaxChangedCells())
+    {
+        m_changedCells.clear();
+        m_allCellsChanged = true;
+        return;
+    }
+    m_changedCells.push_back(cell);
+}
+
+void AsyncPathfinder::cancel()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // The changes a dropped request carried still have to reach the worker
+    if (m_hasPending)
+    {
+        m_changedCells.insert(m_changedCells.end(), m_pending.changedCells.begin(), m_pending.changedCells.end());
+        m_allCellsChanged = m_allCellsChanged || m_pending.allCellsChanged;
+    }
+    m_pending = {};
+    m_hasPending = false;
+    m_cancelRequested = true;
+    m_resultTicket = 0;
+    ++m_nextTicket;                                 // Outstanding tickets now read as cancelled
+}
+
+AsyncPathfinder::Status AsyncPathfinder::poll(Ticket ticket, std::vector<TileIndex>& path)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (ticket != m_resultTicket)
+        return ticket < m_nextTicket - 1 ? Status::Cancelled : Status::Pending;
+
+    if (m_resultStatus == Status::Found)
+        path.swap(m_resultPath);
+    Status status = m_resultStatus;
+    m_resultTicket = 0;
+    return status;
+}
+
+void AsyncPathfinder::run()
+{
+    while (true)
+    {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] { return m_stopping || m_hasPending; });
+            if (m_stopping)
+                return;
+
+            request = std::move(m_pending);
+            m_hasPending = false;
+            m_cancelRequested = false;
+        }
+
+        if (request.prepareOnly)
+        {
+            findPath(request);
+            continue;
+        }
+        bool found = findPath(request);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if ((request.algorithm == Algorithm::AStar && m_search.wasCancelled()) || request.ticket != m_nextTicket - 1)
+            continue;                               // A newer request or a cancel superseded this one
+
+        m_resultTicket = request.ticket;
+        m_resultStatus = found ? Status::Found : Status::NotFound;
+        m_resultPath.swap(m_workerPath);
+    }
+}
+
+bool AsyncPathfinder::findPath(const Request& request)
+{
+    // Cluster changes are applied whatever the algorithm, so switching modes never reads a stale graph
+    const OccupancyGrid& grid = *request.snapshot;
+    if (request.allCellsChanged)
+        m_hierarchicalPathfinder.invalidateAll();
+    for (TileIndex cell : request.changedCells)
+        m_hierarchicalPathfinder.invalidate(grid, cell);
+
+    if (request.prepareOnly)
+    {
+        m_hierarchicalPathfinder.prepare(grid);
+        return false;
+    }
+
+    switch (request.algorithm)
+    {
+    case Algorithm::JumpPoint:
+        return m_jumpPointSearch.findPath(grid, request.start, request.goal, m_workerPath);
+    case Algorithm::Hierarchical:
+        return m_hierarchicalPathfinder.findPath(grid, request.start, request.goal, m_workerPath);
+    default:
+        return m_search.findPath(grid, request.start, request.goal, m_workerPath);
+    }
+}
@@ -0,0 +1,174 @@
+#include "AutoTiler.h"
+#include <algorithm>
+#include <stdexcept>
+#include "TileRules.h"
+
+namespace
+{
+    // Offsets indexed by Direction::Type; NONE is the cell itself
+    constexpr int OFFSETS[9][2] = {
+        { 0, 0 }, { 0, -1 }, { 1, -1 }, { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 }, { -1, 0 }, { -1, -1 }
+    };
+
+    // Bit of a direction in a neighbor mask
+    constexpr int bit(Direction::Type direction) { return 1 << (direction - 1); }
+}
+
+AutoTiler::AutoTiler(int columns, int rows)
+    : m_columns(columns),
+      m_rows(rows),
+      m_cells(static_cast<size_t>(columns) * rows, 0),
+      m_keys(static_cast<size_t>(columns) * rows, 0)
+{
+    internMaterial("");
+}
+
+void AutoTiler::setMaterial(int x, int y, const std::string& material)
+{
+    if (x < 0 || y < 0 || x >= m_columns || y >= m_rows)
+        throw std::out_of_range("setMaterial: Invalid cell");
+    m_cells[toIndex(x, y)] = static_cast<uint16_t>(internMaterial(material));
+}
+
+void AutoTiler::retileAll()
+{
+    for (int y = 0; y < m_rows; ++y)
+    {
+        for (int x = 0; x < m_columns; ++x)
+            m_keys[toIndex(x, y)] = pickKey(x, y);
+    }
+}
+
+void AutoTiler::paint(int x, int y, const std::string& material, std::vector<TileIndex>& changed)
+{
+    setMaterial(x, y, material);
+    changed.clear();
+    for (int ny = std::max(y - 1, 0); ny <= std::min(y + 1, m_rows - 1); ++ny)
+    {
+        for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, m_columns - 1); ++nx)
+        {
+            const TileIndex cell = toIndex(nx, ny);
+            const int key = pickKey(nx, ny);
+            if (key == m_keys[cell])
+                continue;
+            m_keys[cell] = key;
+            changed.push_back(cell);
+        }
+    }
+}
+
+int AutoTiler::pickKey(int x, int y) const
+{
+    const uint16_t material = m_cells[toIndex(x, y)];
+    int mask = 0;
+    for (int direction = Direction::NORTH; direction <= Direction::NORTHWEST; ++direction)
+    {
+        // The map edge continues the cell's own material, so edges don't grow borders
+        const int nx = x + OFFSETS[direction][0];
+        const int ny = y + OFFSETS[direction][1];
+        if (nx < 0 || ny < 0 || nx >= m_columns || ny >= m_rows || m_cells[toIndex(nx, ny)] == material)
+            mask |= bit(static_cast<Direction::Type>(direction));
+    }
+    return m_materials[material].keys[getBorderTable()[mask]];
+}
+
+int AutoTiler::internMaterial(const std::string& material)
+{
+    auto it = m_materialIds.find(material);
+    if (it != m_materialIds.end())
+        return it->second;
+    if (m_materials.size() > UINT16_MAX)
+        throw std::runtime_error("AutoTiler: Too many materials");
+
+    // Resolve every border variant once; missing variants reuse the solid key
+    Material entry{ material, {} };
+    entry.keys[Direction::NONE] = internKey(material, Direction::NONE);
+    const TileRules& rules = TileRules::getInstance();
+    for (int direction = Direction::NORTH; direction <= Direction::NORTHWEST; ++direction)
+    {
+        const Direction::Type border = static_cast<Direction::Type>(direction);
+        const std::string variant = material + "_border_" + Direction::directionToString(border);
+        entry.keys[direction] = rules.findTile(variant) >= 0 ? internKey(variant, border) : entry.keys[Direction::NONE];
+    }
+
+    const int id = static_cast<int>(m_materials.size());
+    m_materials.push_back(std::move(entry));
+    m_materialIds.emplace(material, id);
+    return id;
+}
+
+int AutoTiler::internKey(const std::string& key, Direction::Type border)
+{
+    auto it = m_tileKeyIds.find(key);
+    if (it != m_tileKeyIds.end())
+        return it->second;
+    const int id = static_cast<int>(m_tileKeys.size());
+    m_tileKeys.push_back(key);
+    m_borders.push_back(border);
+    m_tileKeyIds.emplace(key, id);
+    return id;
+}
+
+const std::array<Direction::Type, 256>& AutoTiler::getBorderTable()
+{
+    using namespace Direction;
+    static const std::array<Type, 256> table = []
+    {
+        constexpr Type PRIMARY[4] = { NORTH, EAST, SOUTH, WEST };
+        constexpr Type SECONDARY[4] = { NORTHEAST, SOUTHEAST, SOUTHWEST, NORTHWEST };
+        std::array<Type, 256> borders{};
+        for (int mask = 0; mask < 256; ++mask)
+        {
+            // Directions towards the material: the opposite of every open side
+            int inward = 0;
+            int openSides = 0;
+            for (Type side : PRIMARY)
+            {
+                if (!(mask & bit(side)))
+                {
+                    inward |= bit(getComplimentaryDirection(side));
+                    ++openSides;
+                }
+            }
+
+            Type border = NONE;
+            if (openSides == 1)
+            {
+                for (Type side : PRIMARY)
+                {
+                    if (inward == bit(side))
+                        border = side;
+                }
+            }
+            else if (openSides == 2)
+            {
+                // Outer corner; two opposite open sides leave a strip with no variant
+                for (Type corner : SECONDARY)
+                {
+                    const std::array<Type, 2> parts = decomposeSecondaryDirection(corner);
+                    if (inward == (bit(parts[0]) | bit(parts[1])))
+                        border = corner;
+                }
+            }
+            else if (openSides == 0)
+            {
+                // Inner corner: exactly one open diagonal
+                int openCorners = 0;
+                Type open = NONE;
+                for (Type corner : SECONDARY)
+                {
+                    if (!(mask & bit(corner)))
+                    {
+                        ++openCorners;
+                        open = corner;
+                    }
+                }
+                if (openCorners == 1)
+                    border = getComplimentaryDirection(open);
+            }
+            borders[mask] = border;
+        }
+        return borders;
+    }();
+    return table;
+}
@@ -0,0 +1,176 @@
+#include "BackgroundCache.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Named rather than operators, which raymath may already define for its vectors
+    bool differs(const Vector4& a, const Vector4& b)
+    {
+        return a.x != b.x || a.y != b.y || a.z != b.z || a.w != b.w;
+    }
+
+    bool differs(const Rectangle& a, const Rectangle& b)
+    {
+        return a.x != b.x || a.y != b.y || a.width != b.width || a.height != b.height;
+    }
+}
+
+bool BackgroundCache::build(int columns, int rows)
+{
+    m_target.reset();
+    if (!fits(columns, rows))
+        return false;
+    const int width = columns * Tile::getSize();
+    const int height = rows * Tile::getSize();
+
+    m_columns = columns;
+    m_rows = rows;
+    m_target = std::shared_ptr<const RenderTexture2D>(new RenderTexture2D(LoadRenderTexture(width, height)),
+        [](const RenderTexture2D* target)
+        {
+            UnloadRenderTexture(*target);
+            delete target;
+        });
+    m_tiles.assign(static_cast<size_t>(columns) * rows, {});
+    m_sprites.clear();
+    m_baked.clear();
+    m_dirty.assign(static_cast<size_t>(columns) * rows, 0);
+    m_dirtyTiles.clear();
+    invalidateAll();
+    return true;
+}
+
+void BackgroundCache::invalidate(TileIndex tile)
+{
+    if (tile < 0 || tile >= static_cast<TileIndex>(m_dirty.size()) || m_dirty[tile])
+        return;
+    m_dirty[tile] = 1;
+    m_dirtyTiles.push_back(tile);
+}
+
+void BackgroundCache::invalidate(Rectangle area)
+{
+    const int size = Tile::getSize();
+    const int left = std::max(static_cast<int>(std::floor(area.x / size)), 0);
+    const int top = std::max(static_cast<int>(std::floor(area.y / size)), 0);
+    const int right = std::min(static_cast<int>(std::ceil((area.x + area.width) / size)), m_columns);
+    const int bottom = std::min(static_cast<int>(std::ceil((area.y + area.height) / size)), m_rows);
+    for (int y = top; y < bottom; ++y)
+    {
+        for (int x = left; x < right; ++x)
+            invalidate(y * m_columns + x);
+    }
+}
+
+void BackgroundCache::invalidateAll()
+{
+    for (TileIndex tile = 0; tile < static_cast<TileIndex>(m_dirty.size()); ++tile)
+        invalidate(tile);
+}
+
+void BackgroundCache::sync(const TileGrid& tiles,
+                           const std::vector<std::shared_ptr<Sprite>>& sprites,
+                           std::vector<std::shared_ptr<Sprite>>& live)
+{
+    live.clear();
+    if (!isReady())
+        return;
+
+    // Cells of chunks that aren't loaded have no tile and draw nothing
+    for (TileIndex tile = 0; tile < tiles.getSize() && tile < static_cast<TileIndex>(m_tiles.size()); ++tile)
+    {
+        TileState& state = m_tiles[tile];
+        const std::shared_ptr<Tile>& current = tiles.findTile(tile);
+        const Vector4 offset = current ? current->getColorOffset() : Vector4{};
+        if (state.tile != current || differs(state.offset, offset))
+        {
+            state.tile = current;
+            state.offset = offset;
+            invalidate(tile);
+        }
+    }
+
+    // A sprite that changes in any way dirties both where it was and where it is
+    m_baked.clear();
+    for (const auto& sprite : sprites)
+    {
+        SpriteState current;
+        current.live = sprite->isMoving();
+        current.visible = sprite->getRenderFlag();
+        current.rect = sprite->getRect();
+        current.offset = sprite->getColorOffset();
+
+        auto [it, inserted] = m_sprites.try_emplace(sprite.get(), current);
+        SpriteState& previous = it->second;
+        const bool baked = !current.live && current.visible;
+        if (inserted)
+        {
+            if (baked)
+                invalidate(current.rect);
+        }
+        else if (previous.live != current.live || previous.visible != current.visible ||
+                 differs(previous.rect, current.rect) || differs(previous.offset, current.offset))
+        {
+            if (!previous.live && previous.visible)
+                invalidate(previous.rect);
+            if (baked)
+                invalidate(current.rect);
+            previous = current;
+        }
+
+        if (baked)
+            m_baked.push_back(sprite);
+        else if (current.visible)
+            live.push_back(sprite);
+    }
+}
+
+void BackgroundCache::redraw(const std::function<void(Rectangle)>& drawArea)
+{
+    m_lastRedrawCount = static_cast<int>(m_dirtyTiles.size());
+    if (!isReady() || m_dirtyTiles.empty())
+        return;
+
+    // Neighbouring dirty tiles in a row share one clip rectangle and one redraw
+    std::sort(m_dirtyTiles.begin(), m_dirtyTiles.end());
+    const int size = Tile::getSize();
+    BeginTextureMode(*m_target);
+    size_t i = 0;
+    while (i < m_dirtyTiles.size())
+    {
+        const TileIndex first = m_dirtyTiles[i];
+        size_t end = i + 1;
+        while (end < m_dirtyTiles.size() && m_dirtyTiles[end] == m_dirtyTiles[end - 1] + 1 &&
+               m_dirtyTiles[end] % m_columns != 0)
+            ++end;
+
+        const Rectangle area = {
+            static_cast<float>((first % m_columns) * size),
+            static_cast<float>((first / m_columns) * size),
+            static_cast<float>((end - i) * size),
+            static_cast<float>(size)
+        };
+        BeginScissorMode(static_cast<int>(area.x), static_cast<int>(area.y), static_cast<int>(area.width), size);
+        ClearBackground(RAYWHITE);
+        drawArea(area);
+        EndScissorMode();
+
+        for (size_t j = i; j < end; ++j)
+            m_dirty[m_dirtyTiles[j]] = 0;
+        i = end;
+    }
+    EndTextureMode();
+    m_dirtyTiles.clear();
+}
+
+void BackgroundCache::draw() const
+{
+    if (!isReady())
+        return;
+
+    // Render textures are stored upside down
+    const Texture2D& texture = m_target->texture;
+    const Rectangle source = { 0.0f, 0.0f, static_cast<float>(texture.width), -static_cast<float>(texture.height) };
+    DrawTextureRec(texture, source, { 0.0f, 0.0f }, WHITE);
+}
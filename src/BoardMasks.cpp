@@ -0,0 +1,140 @@
+#include "BoardMasks.h"
+#include <algorithm>
+#include <cstdlib>
+
+int BoardMasks::getSlideDistance(int x, int y, int dirX, int dirY) const
+{
+    if (dirX > 0)
+        return m_occupied.findNextSet(y, x + 1) - x - 1;
+    if (dirX < 0)
+        return x - m_occupied.findPreviousSet(y, x - 1) - 1;
+    if (dirY > 0)
+        return m_occupiedColumns.findNextSet(x, y + 1) - y - 1;
+    if (dirY < 0)
+        return y - m_occupiedColumns.findPreviousSet(x, y - 1) - 1;
+    return 0;
+}
+
+bool BoardMasks::isSolved() const
+{
+    const std::vector<uint64_t>& goals = m_goals.getWords();
+    const std::vector<uint64_t>& occupied = m_occupied.getWords();
+    for (size_t i = 0; i < goals.size(); ++i)
+    {
+        if (goals[i] & ~occupied[i])
+            return false;
+    }
+    return true;
+}
+
+void BoardMasks::fillReachable(int x, int y, BitGrid& reached) const
+{
+    const int columns = getColumns();
+    const int rows = getRows();
+    const int wordsPerRow = m_occupied.getWordsPerRow();
+    if (reached.getColumns() != columns || reached.getRows() != rows)
+        reached = BitGrid(columns, rows);
+    else
+        reached.clear();
+    m_rowOpen.resize(wordsPerRow);
+    m_rowQueued.assign(rows, 0);
+    m_pendingRows.clear();
+
+    // Seed the open neighbors too, so an occupied start still spreads
+    const int seeds[5][2] = { { x, y }, { x - 1, y }, { x + 1, y }, { x, y - 1 }, { x, y + 1 } };
+    for (const auto& seed : seeds)
+    {
+        if (seed[0] >= 0 && seed[1] >= 0 && seed[0] < columns && seed[1] < rows && !m_occupied.test(seed[0], seed[1]))
+            reached.set(seed[0], seed[1], true);
+    }
+
+    // Queue the seeded rows and their neighbors; after that a row is only refilled when a neighbor gained bits.
+    // Bit 0 of m_rowQueued marks a queued row and bit 1 a row that was filled before
+    for (int row = std::max(0, y - 2); row <= std::min(rows - 1, y + 2); ++row)
+    {
+        m_pendingRows.push_back(row);
+        m_rowQueued[row] = 1;
+    }
+
+    while (!m_pendingRows.empty())
+    {
+        const int row = m_pendingRows.back();
+        m_pendingRows.pop_back();
+        const bool firstVisit = m_rowQueued[row] == 1;
+        m_rowQueued[row] = 2;
+
+        uint64_t* current = reached.getRow(row);
+        const uint64_t* occupied = m_occupied.getRow(row);
+        const uint64_t* above = row > 0 ? reached.getRow(row - 1) : nullptr;
+        const uint64_t* below = row < rows - 1 ? reached.getRow(row + 1) : nullptr;
+        uint64_t difference = 0;
+        for (int word = 0; word < wordsPerRow; ++word)
+        {
+            m_rowOpen[word] = ~occupied[word] & m_occupied.getColumnMask(word);
+            uint64_t spread = current[word];
+            if (above)
+                spread |= above[word];
+            if (below)
+                spread |= below[word];
+            spread &= m_rowOpen[word];
+            difference |= spread ^ current[word];
+            current[word] = spread;
+        }
+
+        // Seeded rows announce themselves once even if filling added nothing
+        const bool seeded = firstVisit && std::abs(row - y) <= 1;
+        difference |= fillRow(current, m_rowOpen.data());
+        if (!difference && !seeded)
+            continue;
+
+        for (int neighbor = row - 1; neighbor <= row + 1; neighbor += 2)
+        {
+            if (neighbor < 0 || neighbor >= rows || (m_rowQueued[neighbor] & 1))
+                continue;
+            m_rowQueued[neighbor] |= 1;
+            m_pendingRows.push_back(neighbor);
+        }
+    }
+
+    reached.set(x, y, true);
+}
+
+uint64_t BoardMasks::fillRow(uint64_t* reached, const uint64_t* open) const
+{
+    const int wordsPerRow = m_occupied.getWordsPerRow();
+    uint64_t difference = 0;
+
+    // Adding the seeds to the open mask carries through each run above a seed
+    uint64_t carry = 0;
+    for (int word = 0; word < wordsPerRow; ++word)
+    {
+        const uint64_t seeds = (reached[word] | carry) & open[word];
+        const uint64_t filled = (((open[word] + seeds) ^ open[word]) & open[word]) | seeds;
+        difference |= filled ^ reached[word];
+        reached[word] = filled;
+        carry = filled >> 63;
+    }
+
+    // Carries only run upward, so the runs below each seed use a doubling shift fill instead
+    carry = 0;
+    for (int word = wordsPerRow - 1; word >= 0; --word)
+    {
+        uint64_t filled = (reached[word] | (carry << 63)) & open[word];
+        uint64_t runs = open[word];
+        filled |= runs & (filled >> 1);
+        runs &= runs >> 1;
+        filled |= runs & (filled >> 2);
+        runs &= runs >> 2;
+        filled |= runs & (filled >> 4);
+        runs &= runs >> 4;
+        filled |= runs & (filled >> 8);
+        runs &= runs >> 8;
+        filled |= runs & (filled >> 16);
+        runs &= runs >> 16;
+        filled |= runs & (filled >> 32);
+        difference |= filled ^ reached[word];
+        reached[word] = filled;
+        carry = filled & 1;
+    }
+    return difference;
+}
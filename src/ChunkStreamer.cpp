@@ -0,0 +1,329 @@
+#include "ChunkStreamer.h"
+#include <algorithm>
+#include <stdexcept>
+#include "AutoTiler.h"
+#include "LevelData.h"
+#include "LevelText.h"
+
+ChunkStreamer::ChunkStreamer(const std::string& path, int chunkSize, int maxColumns, int maxRows)
+    : m_file(path),
+      m_chunkSize(chunkSize)
+{
+    if (chunkSize <= 0)
+        throw std::invalid_argument("ChunkStreamer: Invalid chunk size");
+    index(maxColumns, maxRows);
+
+    const int chunks = getChunkCount();
+    m_resident.assign(chunks, 0);
+    m_pinned.assign(chunks, 0);
+    m_requested.assign(chunks, 0);
+    m_lruPositions.resize(chunks);
+    m_lastWanted.assign(chunks, 0);
+    m_worker = std::thread(&ChunkStreamer::run, this);
+}
+
+ChunkStreamer::~ChunkStreamer()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_one();
+    m_worker.join();
+}
+
+void ChunkStreamer::index(int maxColumns, int maxRows)
+{
+    // Same "rows,columns" header LevelData reads
+    const char* data = m_file.getData();
+    const char* end = data + m_file.getSize();
+    const char* lineEnd = LevelText::findLineEnd(data, end);
+    const char* separator = LevelText::findDelimiter(data, lineEnd);
+    try
+    {
+        m_rows = std::stoi(std::string(LevelText::trim(data, separator)));
+        m_columns = separator < lineEnd ? std::stoi(std::string(LevelText::trim(separator + 1, lineEnd))) : 0;
+    }
+    catch (const std::logic_error&)
+    {
+        m_rows = m_columns = 0;
+    }
+    if (m_rows <= 0 || m_columns <= 0 || m_rows > maxRows || m_columns > maxColumns)
+        throw std::runtime_error("Invalid board dimensions in mapped level");
+
+    // Every cell but the last is followed by a delimiter, so a header promising more cells than that is cut short
+    if (static_cast<uint64_t>(m_rows) * m_columns * MATRIX_COUNT > m_file.getSize() + 1)
+        throw std::runtime_error("Unexpected end of file in matrix data");
+
+    m_chunkColumns = (m_columns + m_chunkSize - 1) / m_chunkSize;
+    m_chunkRows = (m_rows + m_chunkSize - 1) / m_chunkSize;
+    m_rowStarts.resize(static_cast<size_t>(MATRIX_COUNT) * m_rows);
+    m_chunkOffsets.resize(static_cast<size_t>(MATRIX_COUNT) * m_rows * m_chunkColumns);
+    m_goals = BitGrid(m_columns, m_rows);
+    m_immovables = BitGrid(m_columns, m_rows);
+    m_movables = BitGrid(m_columns, m_rows);
+
+    size_t position = static_cast<size_t>(lineEnd - data);
+    for (int matrix = 0; matrix < MATRIX_COUNT; ++matrix)
+        position = indexMatrix(position, static_cast<Matrix>(matrix));
+}
+
+size_t ChunkStreamer::indexMatrix(size_t position, Matrix matrix)
+{
+    const char* data = m_file.getData();
+    const char* end = data + m_file.getSize();
+    const char* line = data + position;
+    LevelText::DelimiterScanner scanner(line, end);
+    for (int y = 0; y < m_rows; ++y)
+    {
+        // Skip lines that contain only whitespace, as LevelData does
+        const char* lineEnd;
+        while (true)
+        {
+            if (line >= end)
+                throw std::runtime_error("Unexpected end of file in matrix data");
+            lineEnd = LevelText::findLineEnd(line, end);
+            if (!LevelText::trim(line, lineEnd).empty())
+                break;
+            line = lineEnd < end ? lineEnd + 1 : end;
+        }
+
+        const size_t row = static_cast<size_t>(matrix) * m_rows + y;
+        m_rowStarts[row] = static_cast<uint64_t>(line - data);
+        uint32_t* offsets = &m_chunkOffsets[row * m_chunkColumns];
+        int x = 0;
+        const char* cell = line;
+        while (true)
+        {
+            const char* cellEnd = scanner.next(cell);      // Stops at lineEnd at the latest
+            if (x < m_columns)
+            {
+                if (x % m_chunkSize == 0)
+                    offsets[x / m_chunkSize] = static_cast<uint32_t>(cell - line);
+
+                const std::string_view key = LevelText::trim(cell, cellEnd);
+                if (matrix == TILES)
+                    m_goals.set(x, y, !key.empty() && key.front() == LevelData::getGoalMarker());
+                else if (key != LevelData::getEmptyKey())
+                    (matrix == IMMOVABLES ? m_immovables : m_movables).set(x, y, true);
+            }
+            ++x;
+            if (cellEnd == lineEnd)
+                break;
+            cell = cellEnd + 1;
+        }
+
+        if (x != m_columns)
+        {
+            throw std::runtime_error(
+                "Row size mismatch in matrix data; row size: " + std::to_string(x) +
+                ", expected: " + std::to_string(m_columns));
+        }
+        line = lineEnd < end ? lineEnd + 1 : end;
+    }
+    return static_cast<size_t>(line - data);
+}
+
+std::shared_ptr<const ChunkStreamer::ChunkData> ChunkStreamer::read(int chunk) const
+{
+    if (chunk < 0 || chunk >= getChunkCount())
+        throw std::out_of_range("ChunkStreamer: Invalid chunk");
+
+    auto data = std::make_shared<ChunkData>();
+    data->chunk = chunk;
+    data->left = (chunk % m_chunkColumns) * m_chunkSize;
+    data->top = (chunk / m_chunkColumns) * m_chunkSize;
+    data->width = std::min(m_chunkSize, m_columns - data->left);
+    data->height = std::min(m_chunkSize, m_rows - data->top);
+    const size_t cells = static_cast<size_t>(data->width) * data->height;
+    data->tileKeys.resize(cells);
+    data->borders.resize(cells);
+    data->immovableKeys.resize(cells);
+    data->movableKeys.resize(cells);
+    data->goals.assign(cells, 0);
+
+    for (int y = data->top; y < data->top + data->height; ++y)
+    {
+        const size_t slot = data->toSlot(data->left, y);
+        parseRow(IMMOVABLES, y, data->left, data->left + data->width, &data->immovableKeys[slot]);
+        parseRow(MOVABLES, y, data->left, data->left + data->width, &data->movableKeys[slot]);
+    }
+
+    // Materials are read with a one-cell ring clipped to the board, which is every neighbor a border
+    // depends on; where the ring is clipped the board edge continues the material, as it does in a full retile
+    const int ringLeft = std::max(data->left - 1, 0);
+    const int ringTop = std::max(data->top - 1, 0);
+    const int ringWidth = std::min(data->left + data->width + 1, m_columns) - ringLeft;
+    const int ringHeight = std::min(data->top + data->height + 1, m_rows) - ringTop;
+    std::vector<std::string> materials(static_cast<size_t>(ringWidth) * ringHeight);
+    for (int y = 0; y < ringHeight; ++y)
+        parseRow(TILES, ringTop + y, ringLeft, ringLeft + ringWidth, &materials[static_cast<size_t>(y) * ringWidth]);
+
+    // The goal marker isn't part of the material
+    AutoTiler tiler(ringWidth, ringHeight);
+    for (int y = 0; y < ringHeight; ++y)
+    {
+        for (int x = 0; x < ringWidth; ++x)
+        {
+            std::string& material = materials[static_cast<size_t>(y) * ringWidth + x];
+            if (!material.empty() && material.front() == LevelData::getGoalMarker())
+                material.erase(0, 1);
+            tiler.setMaterial(x, y, material);
+        }
+    }
+    tiler.retileAll();
+
+    for (int y = data->top; y < data->top + data->height; ++y)
+    {
+        for (int x = data->left; x < data->left + data->width; ++x)
+        {
+            const int slot = data->toSlot(x, y);
+            data->tileKeys[slot] = tiler.getTileKey(x - ringLeft, y - ringTop);
+            data->borders[slot] = tiler.getBorder(x - ringLeft, y - ringTop);
+            data->goals[slot] = m_goals.test(x, y) ? 1 : 0;
+        }
+    }
+    return data;
+}
+
+void ChunkStreamer::parseRow(Matrix matrix, int y, int left, int right, std::string* keys) const
+{
+    // The index pass already validated every row, so the cells are all there
+    const size_t row = static_cast<size_t>(matrix) * m_rows + y;
+    const char* end = m_file.getData() + m_file.getSize();
+    const char* line = m_file.getData() + m_rowStarts[row];
+    const char* lineEnd = LevelText::findLineEnd(line, end);
+
+    // Start from the chunk at or after left; a ring cell just before it is found by stepping back a cell
+    const int chunkColumn = (left + m_chunkSize - 1) / m_chunkSize;
+    const char* cell = line + m_chunkOffsets[row * m_chunkColumns + chunkColumn];
+    for (int x = chunkColumn * m_chunkSize; x > left; --x)
+    {
+        --cell;
+        while (cell > line && cell[-1] != ',')
+            --cell;
+    }
+
+    for (int x = left; x < right; ++x)
+    {
+        const char* cellEnd = LevelText::findDelimiter(cell, lineEnd);
+        keys[x - left] = std::string(LevelText::trim(cell, cellEnd));
+        if (cellEnd == lineEnd)
+            break;
+        cell = cellEnd + 1;
+    }
+}
+
+void ChunkStreamer::update(const std::vector<int>& wanted,
+                           std::vector<std::shared_ptr<const ChunkData>>& ready,
+                           std::vector<int>& evicted)
+{
+    ++m_updateCount;
+    ready.clear();
+    evicted.clear();
+
+    // Collect finished chunks and withdraw queued ones; the wanted list decides what is queued next
+    std::vector<std::shared_ptr<const ChunkData>> done;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        done.swap(m_done);
+        for (int chunk : m_queue)
+            m_requested[chunk] = 0;
+        m_queue.clear();
+    }
+    for (std::shared_ptr<const ChunkData>& data : done)
+    {
+        m_requested[data->chunk] = 0;
+        if (m_resident[data->chunk])
+            continue;                               // Already loaded through read()
+        markResident(data->chunk);
+        ready.push_back(std::move(data));
+    }
+
+    std::vector<int> queue;
+    for (int chunk : wanted)
+    {
+        m_lastWanted[chunk] = m_updateCount;
+        if (m_resident[chunk])
+        {
+            if (!m_pinned[chunk])
+                m_lru.splice(m_lru.begin(), m_lru, m_lruPositions[chunk]);
+        }
+        else if (!m_requested[chunk])
+        {
+            m_requested[chunk] = 1;
+            queue.push_back(chunk);
+        }
+    }
+    if (!queue.empty())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.assign(queue.begin(), queue.end());
+        }
+        m_condition.notify_one();
+    }
+
+    // Wanted chunks sit at the front, so reaching one means the rest are wanted too
+    while (static_cast<int>(m_lru.size()) > m_chunkBudget)
+    {
+        const int chunk = m_lru.back();
+        if (m_lastWanted[chunk] == m_updateCount)
+            break;
+        m_lru.pop_back();
+        m_resident[chunk] = 0;
+        --m_residentCount;
+        evicted.push_back(chunk);
+    }
+}
+
+void ChunkStreamer::markResident(int chunk)
+{
+    if (m_resident[chunk])
+        return;
+    m_resident[chunk] = 1;
+    ++m_residentCount;
+    if (!m_pinned[chunk])
+    {
+        m_lru.push_front(chunk);
+        m_lruPositions[chunk] = m_lru.begin();
+    }
+}
+
+void ChunkStreamer::pin(int chunk)
+{
+    if (m_pinned[chunk])
+        return;
+    m_pinned[chunk] = 1;
+    if (m_resident[chunk])
+        m_lru.erase(m_lruPositions[chunk]);
+}
+
+bool ChunkStreamer::isLoading() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return !m_queue.empty() || m_parsing >= 0 || !m_done.empty();
+}
+
+void ChunkStreamer::run()
+{
+    while (true)
+    {
+        int chunk;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+            if (m_stopping)
+                return;
+            chunk = m_queue.front();
+            m_queue.pop_front();
+            m_parsing = chunk;
+        }
+
+        std::shared_ptr<const ChunkData> data = read(chunk);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_done.push_back(std::move(data));
+        m_parsing = -1;
+    }
+}
@@ -0,0 +1,389 @@
+#include "CooperativePlanner.h"
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <stdexcept>
+
+namespace
+{
+    constexpr int INF = INT_MAX / 4;
+
+    // Goal fields cost a full board sweep each, so only a few are built per frame
+    constexpr int FIELD_BUILDS_PER_FRAME = 4;
+}
+
+CooperativePlanner::AgentId CooperativePlanner::addAgent(const OccupancyGrid& grid, TileIndex position, TileIndex goal)
+{
+    if (m_agentAt.size() != grid.getSize())
+        m_agentAt.assign(grid.getSize(), -1);
+
+    if (position < 0 || position >= grid.getSize() || goal < 0 || goal >= grid.getSize())
+        throw std::out_of_range("addAgent: Invalid tile");
+
+    if (m_agentAt.get(position) >= 0)
+        throw std::runtime_error("addAgent: Tile already holds an agent");
+
+    const AgentId id = static_cast<AgentId>(m_agents.size());
+    Agent agent;
+    agent.position = position;
+    agent.goal = goal;
+    agent.route.push_back(position);
+    agent.routeTick = m_tick;
+    m_agents.push_back(std::move(agent));
+    m_agentAt.set(position, id);
+
+    reserve(id);
+    queueReplan(id);
+    return id;
+}
+
+void CooperativePlanner::setGoal(AgentId agent, TileIndex goal)
+{
+    if (m_agents[agent].goal == goal)
+        return;
+    m_agents[agent].goal = goal;
+    queueReplan(agent);
+}
+
+void CooperativePlanner::relocate(AgentId id, TileIndex position)
+{
+    Agent& agent = m_agents[id];
+    if (agent.position == position)
+        return;
+
+    unreserve(id);
+    m_agentAt.set(agent.position, -1);
+    m_agentAt.set(position, id);
+    agent.position = position;
+    agent.route.assign(1, position);
+    agent.routeTick = m_tick;
+    reserve(id);
+    queueReplan(id);
+}
+
+void CooperativePlanner::notifyCellChanged()
+{
+    ++m_staticVersion;
+
+    // Any route may cross the changed cell; the per-frame budget spreads the work out
+    for (AgentId id = 0; id < getAgentCount(); ++id)
+        queueReplan(id);
+}
+
+void CooperativePlanner::plan(const OccupancyGrid& grid)
+{
+    int fieldBuilds = 0;
+    for (int i = 0; i < m_replansPerFrame && !m_replanQueue.empty(); ++i)
+    {
+        AgentId id = m_replanQueue.front();
+        m_replanQueue.pop_front();
+        if (!hasGoalDistances(grid, m_agents[id].goal))
+        {
+            if (fieldBuilds == FIELD_BUILDS_PER_FRAME)
+            {
+                m_replanQueue.push_back(id);
+                continue;
+            }
+            ++fieldBuilds;
+        }
+        planAgent(grid, id);
+    }
+}
+
+const std::vector<CooperativePlanner::Move>& CooperativePlanner::advance(const OccupancyGrid& grid)
+{
+    m_moves.clear();
+    m_pending.clear();
+
+    for (AgentId id = 0; id < getAgentCount(); ++id)
+    {
+        Agent& agent = m_agents[id];
+        auto it = m_reservations.find(toReservationKey(getPlannedCell(agent, m_tick), m_tick));
+        if (it != m_reservations.end() && it->second == id)
+            m_reservations.erase(it);
+
+        TileIndex next = getPlannedCell(agent, m_tick + 1);
+        if (next < 0 || getPlannedCell(agent, m_tick) != agent.position)
+        {
+            queueReplan(id);
+            continue;
+        }
+
+        if (next == agent.position)
+            continue;
+
+        if (isStaticBlocked(grid, next))
+        {
+            queueReplan(id);
+            continue;
+        }
+        m_pending.push_back({ id, agent.position, next });
+    }
+
+    // Agents following each other move in the same step, so keep sweeping while cells free up
+    bool progress = true;
+    while (progress && !m_pending.empty())
+    {
+        progress = false;
+        for (size_t i = 0; i < m_pending.size();)
+        {
+            const Move move = m_pending[i];
+            if (m_agentAt.get(move.to) >= 0)
+            {
+                ++i;
+                continue;
+            }
+
+            m_agentAt.set(move.from, -1);
+            m_agentAt.set(move.to, move.agent);
+            m_agents[move.agent].position = move.to;
+            m_moves.push_back(move);
+            m_pending[i] = m_pending.back();
+            m_pending.pop_back();
+            progress = true;
+        }
+    }
+
+    // Whoever is still blocked waits here and picks a new route
+    for (const Move& move : m_pending)
+        queueReplan(move.agent);
+
+    ++m_tick;
+    for (AgentId id = 0; id < getAgentCount(); ++id)
+    {
+        const Agent& agent = m_agents[id];
+        const int64_t remaining = agent.routeTick + static_cast<int64_t>(agent.route.size()) - 1 - m_tick;
+        if (remaining <= m_window / 2)
+            queueReplan(id);
+    }
+    return m_moves;
+}
+
+bool CooperativePlanner::isStaticBlocked(const OccupancyGrid& grid, TileIndex cell) const
+{
+    return grid.isBlocked(cell) && m_agentAt.get(cell) < 0;
+}
+
+bool CooperativePlanner::hasGoalDistances(const OccupancyGrid& grid, TileIndex goal) const
+{
+    auto it = m_goalDistances.find(goal);
+    return it != m_goalDistances.end() && it->second.first == m_staticVersion &&
+           it->second.second.size() == grid.getSize();
+}
+
+const PagedArray<int>& CooperativePlanner::getGoalDistances(const OccupancyGrid& grid, TileIndex goal)
+{
+    auto& entry = m_goalDistances[goal];
+    PagedArray<int>& distances = entry.second;
+    if (hasGoalDistances(grid, goal))
+        return distances;
+
+    entry.first = m_staticVersion;
+    distances.assign(grid.getSize(), INF);
+    m_queue.clear();
+    m_queue.push_back(goal);
+    distances.set(goal, 0);
+
+    std::array<TileIndex, 4> neighbors;
+    for (size_t head = 0; head < m_queue.size(); ++head)
+    {
+        TileIndex current = m_queue[head];
+        const int distance = distances.get(current) + 1;
+        const int count = grid.getNeighbors(current, neighbors);
+        for (int i = 0; i < count; ++i)
+        {
+            TileIndex neighbor = neighbors[i];
+            int& neighborDistance = distances.edit(neighbor);
+            if (neighborDistance != INF || isStaticBlocked(grid, neighbor))
+                continue;
+            neighborDistance = distance;
+            m_queue.push_back(neighbor);
+        }
+    }
+    return distances;
+}
+
+void CooperativePlanner::planAgent(const OccupancyGrid& grid, AgentId id)
+{
+    Agent& agent = m_agents[id];
+    agent.queued = false;
+    unreserve(id);
+    agent.route.assign(1, agent.position);
+    agent.routeTick = m_tick;
+
+    const PagedArray<int>& distances = getGoalDistances(grid, agent.goal);
+    if (distances.get(agent.position) == INF)
+    {
+        reserve(id);
+        return;
+    }
+
+    // Size the node table so it never fills beyond half: every expansion adds at most five nodes
+    const size_t required = static_cast<size_t>(m_maxExpansions) * 10 + 2;
+    if (m_nodes.size() < required)
+    {
+        size_t capacity = 1;
+        while (capacity < required)
+            capacity <<= 1;
+        m_nodes.assign(capacity, Node{});
+        m_generation = 0;
+    }
+    if (++m_generation == 0)
+    {
+        std::fill(m_nodes.begin(), m_nodes.end(), Node{});
+        m_generation = 1;
+    }
+    m_open.clear();
+
+    const int64_t stride = m_window + 1;
+    const int startSlot = findSlot(agent.position * stride);
+    m_nodes[startSlot].g = 0;
+    m_nodes[startSlot].parent = -1;
+    m_open.push_back({ distances.get(agent.position), distances.get(agent.position), startSlot });
+
+    int best = startSlot;
+    int bestH = distances.get(agent.position);
+    int bestStep = 0;
+    int expansions = 0;
+    std::array<TileIndex, 5> moves;
+    while (!m_open.empty() && expansions < m_maxExpansions)
+    {
+        std::pop_heap(m_open.begin(), m_open.end());
+        const OpenEntry entry = m_open.back();
+        m_open.pop_back();
+
+        Node& node = m_nodes[entry.slot];
+        if (node.closed)
+            continue;
+        node.closed = true;
+        ++expansions;
+
+        const TileIndex cell = static_cast<TileIndex>(node.key / stride);
+        const int step = static_cast<int>(node.key % stride);
+        if (step == m_window)
+        {
+            best = entry.slot;
+            break;
+        }
+
+        // With the search cut short, fall back to whatever got closest to the goal
+        if (entry.h < bestH || (entry.h == bestH && step > bestStep))
+        {
+            best = entry.slot;
+            bestH = entry.h;
+            bestStep = step;
+        }
+
+        const int64_t tick = m_tick + step;
+        std::array<TileIndex, 4> neighbors;
+        const int count = grid.getNeighbors(cell, neighbors);
+        std::copy(neighbors.begin(), neighbors.begin() + count, moves.begin());
+        moves[count] = cell;
+
+        const int g = node.g;
+        for (int i = 0; i <= count; ++i)
+        {
+            TileIndex next = moves[i];
+            if (distances.get(next) == INF || isReserved(next, tick + 1, id))
+                continue;
+
+            if (next != cell)
+            {
+                if (isStaticBlocked(grid, next))
+                    continue;
+
+                // Two agents may not trade places within one step
+                auto oncoming = m_reservations.find(toReservationKey(next, tick));
+                if (oncoming != m_reservations.end() && oncoming->second != id)
+                {
+                    auto behind = m_reservations.find(toReservationKey(cell, tick + 1));
+                    if (behind != m_reservations.end() && behind->second == oncoming->second)
+                        continue;
+                }
+            }
+
+            // Waiting on the goal is free so agents that arrived early stay put
+            const int cost = (next == cell && cell == agent.goal) ? 0 : 1;
+            const int slot = findSlot(next * stride + step + 1);
+            Node& child = m_nodes[slot];
+            if (child.closed || (child.parent >= 0 && g + cost >= child.g))
+                continue;
+
+            child.g = g + cost;
+            child.parent = entry.slot;
+            m_open.push_back({ child.g + distances.get(next), distances.get(next), slot });
+            std::push_heap(m_open.begin(), m_open.end());
+        }
+    }
+
+    size_t length = 0;
+    for (int slot = best; slot >= 0; slot = m_nodes[slot].parent)
+        ++length;
+    agent.route.resize(length);
+    for (int slot = best; slot >= 0; slot = m_nodes[slot].parent)
+        agent.route[--length] = static_cast<TileIndex>(m_nodes[slot].key / stride);
+
+    reserve(id);
+}
+
+void CooperativePlanner::queueReplan(AgentId id)
+{
+    if (m_agents[id].queued)
+        return;
+    m_agents[id].queued = true;
+    m_replanQueue.push_back(id);
+}
+
+void CooperativePlanner::reserve(AgentId id)
+{
+    const Agent& agent = m_agents[id];
+    for (size_t i = 0; i < agent.route.size(); ++i)
+        m_reservations[toReservationKey(agent.route[i], agent.routeTick + static_cast<int64_t>(i))] = id;
+}
+
+void CooperativePlanner::unreserve(AgentId id)
+{
+    const Agent& agent = m_agents[id];
+    for (int64_t tick = std::max(agent.routeTick, m_tick); tick < agent.routeTick + static_cast<int64_t>(agent.route.size()); ++tick)
+    {
+        auto it = m_reservations.find(toReservationKey(getPlannedCell(agent, tick), tick));
+        if (it != m_reservations.end() && it->second == id)
+            m_reservations.erase(it);
+    }
+}
+
+bool CooperativePlanner::isReserved(TileIndex cell, int64_t tick, AgentId agent) const
+{
+    auto it = m_reservations.find(toReservationKey(cell, tick));
+    return it != m_reservations.end() && it->second != agent;
+}
+
+TileIndex CooperativePlanner::getPlannedCell(const Agent& agent, int64_t tick) const
+{
+    const int64_t offset = tick - agent.routeTick;
+    if (offset < 0 || offset >= static_cast<int64_t>(agent.route.size()))
+        return -1;
+    return agent.route[static_cast<size_t>(offset)];
+}
+
+int CooperativePlanner::findSlot(int64_t key)
+{
+    const size_t mask = m_nodes.size() - 1;
+    size_t slot = static_cast<size_t>((static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull) >> 20) & mask;
+    while (true)
+    {
+        Node& node = m_nodes[slot];
+        if (node.generation != m_generation)
+        {
+            node.key = key;
+            node.g = 0;
+            node.parent = -1;
+            node.closed = false;
+            node.generation = m_generation;
+            return static_cast<int>(slot);
+        }
+        if (node.key == key)
+            return static_cast<int>(slot);
+        slot = (slot + 1) & mask;
+    }
+}
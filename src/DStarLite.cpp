@@ -0,0 +1,161 @@
+#include "DStarLite.h"
+#include <algorithm>
+#include <array>
+
+void DStarLite::initialize(const OccupancyGrid& grid, TileIndex start, TileIndex goal)
+{
+    const int size = grid.getSize();
+    if (m_open.capacity() != size)
+        m_open.resize(size);
+    else
+        m_open.clear();
+
+    m_g.assign(size, INF);
+    m_rhs.assign(size, INF);
+    m_start = start;
+    m_lastStart = start;
+    m_goal = goal;
+    m_keyModifier = 0;
+
+    m_rhs.set(goal, 0);
+    m_open.push(goal, calculateKey(grid, goal));
+}
+
+DStarLite::Key DStarLite::calculateKey(const OccupancyGrid& grid, TileIndex cell) const
+{
+    int best = std::min(m_g.get(cell), m_rhs.get(cell));
+    if (best >= INF)
+        return { INF, INF };
+    return { best + grid.getDistance(m_start, cell) + m_keyModifier, best };
+}
+
+int DStarLite::getCost(const OccupancyGrid& grid, TileIndex from, TileIndex to) const
+{
+    // The start cell holds the agent itself, so it is never treated as blocked
+    if ((from != m_start && grid.isBlocked(from)) || grid.isBlocked(to))
+        return INF;
+    return 1;
+}
+
+void DStarLite::updateVertex(const OccupancyGrid& grid, TileIndex cell)
+{
+    if (cell != m_goal)
+    {
+        int best = INF;
+        std::array<TileIndex, 4> neighbors;
+        const int count = grid.getNeighbors(cell, neighbors);
+        for (int i = 0; i < count; ++i)
+        {
+            int cost = getCost(grid, cell, neighbors[i]);
+            if (cost < INF && m_g.get(neighbors[i]) < INF)
+                best = std::min(best, cost + m_g.get(neighbors[i]));
+        }
+        m_rhs.set(cell, best);
+    }
+
+    if (m_g.get(cell) != m_rhs.get(cell))
+        m_open.push(cell, calculateKey(grid, cell));
+    else
+        m_open.remove(cell);
+}
+
+void DStarLite::updateStart(const OccupancyGrid& grid, TileIndex start)
+{
+    if (!isActive() || start == m_start)
+        return;
+
+    TileIndex previous = m_start;
+    m_keyModifier += grid.getDistance(m_lastStart, start);
+    m_lastStart = start;
+    m_start = start;
+
+    // Edge costs out of the start cell depend on which cell the agent stands on
+    updateVertex(grid, previous);
+    updateVertex(grid, start);
+}
+
+void DStarLite::notifyCellChanged(const OccupancyGrid& grid, TileIndex cell)
+{
+    if (!isActive())
+        return;
+
+    updateVertex(grid, cell);
+    std::array<TileIndex, 4> neighbors;
+    const int count = grid.getNeighbors(cell, neighbors);
+    for (int i = 0; i < count; ++i)
+        updateVertex(grid, neighbors[i]);
+}
+
+bool DStarLite::computeShortestPath(const OccupancyGrid& grid)
+{
+    if (!isActive())
+        return false;
+
+    std::array<TileIndex, 4> neighbors;
+    while (!m_open.empty() &&
+           (m_open.topKey() < calculateKey(grid, m_start) || m_rhs.get(m_start) != m_g.get(m_start)))
+    {
+        TileIndex cell = m_open.top();
+        Key oldKey = m_open.topKey();
+        Key newKey = calculateKey(grid, cell);
+
+        if (oldKey < newKey)
+        {
+            m_open.push(cell, newKey);
+            continue;
+        }
+
+        m_open.pop();
+        const int count = grid.getNeighbors(cell, neighbors);
+        if (m_g.get(cell) > m_rhs.get(cell))
+        {
+            m_g.set(cell, m_rhs.get(cell));
+        }
+        else
+        {
+            m_g.set(cell, INF);
+            updateVertex(grid, cell);
+        }
+
+        for (int i = 0; i < count; ++i)
+            updateVertex(grid, neighbors[i]);
+    }
+    return m_g.get(m_start) < INF || m_rhs.get(m_start) < INF;
+}
+
+bool DStarLite::extractPath(const OccupancyGrid& grid, std::vector<TileIndex>& path) const
+{
+    path.clear();
+    if (!isActive() || std::min(m_g.get(m_start), m_rhs.get(m_start)) >= INF)
+        return false;
+
+    std::array<TileIndex, 4> neighbors;
+    TileIndex current = m_start;
+    path.push_back(current);
+    while (current != m_goal)
+    {
+        TileIndex next = -1;
+        int best = INF;
+        const int count = grid.getNeighbors(current, neighbors);
+        for (int i = 0; i < count; ++i)
+        {
+            if (getCost(grid, current, neighbors[i]) >= INF || m_g.get(neighbors[i]) >= INF)
+                continue;
+            if (m_g.get(neighbors[i]) < best)
+            {
+                best = m_g.get(neighbors[i]);
+                next = neighbors[i];
+            }
+        }
+
+        // g-values strictly decrease towards the goal on a consistent search
+        if (next < 0 || static_cast<int>(path.size()) > grid.getSize())
+        {
+            path.clear();
+            return false;
+        }
+        current = next;
+        path.push_back(current);
+    }
+    return true;
+}
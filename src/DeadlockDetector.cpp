@@ -0,0 +1,127 @@
+#include "DeadlockDetector.h"
+
+namespace
+{
+    constexpr int DIRECTIONS[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+
+    bool isOpen(const BitGrid& blocked, int x, int y)
+    {
+        return x >= 0 && y >= 0 && x < blocked.getColumns() && y < blocked.getRows() && !blocked.test(x, y);
+    }
+}
+
+bool DeadlockDetector::canPushFrom(const BitGrid& blocked, int x, int y, int dirX, int dirY) const
+{
+    // Mirrors pushObject: diagonal neighbors push vertically, so three cells can push up or down
+    if (dirX != 0)
+        return isOpen(blocked, x - dirX, y);
+    return isOpen(blocked, x - 1, y - dirY) || isOpen(blocked, x, y - dirY) || isOpen(blocked, x + 1, y - dirY);
+}
+
+void DeadlockDetector::build(const BoardMasks& masks, int objectCount)
+{
+    const int columns = masks.getColumns();
+    const int rows = masks.getRows();
+    const BitGrid& walls = masks.getWalls();
+    m_live = BitGrid(columns, rows);
+
+    // Search backwards from the goals: a cell is live if a slide from it can stop on a live cell
+    std::vector<TileIndex> queue;
+    for (int y = 0; y < rows; ++y)
+    {
+        for (int x = 0; x < columns; ++x)
+        {
+            if (masks.isGoal(x, y) && !walls.test(x, y))
+            {
+                m_live.set(x, y, true);
+                queue.push_back(y * columns + x);
+            }
+        }
+    }
+
+    const bool stoppers = objectCount > 1;
+    for (size_t head = 0; head < queue.size(); ++head)
+    {
+        const int stopX = queue[head] % columns;
+        const int stopY = queue[head] / columns;
+        for (const auto& direction : DIRECTIONS)
+        {
+            const int dirX = direction[0];
+            const int dirY = direction[1];
+
+            // Without another object to stop against, a slide only ends in front of a wall or the edge
+            if (!stoppers && isOpen(walls, stopX + dirX, stopY + dirY))
+                continue;
+
+            for (int x = stopX - dirX, y = stopY - dirY; isOpen(walls, x, y); x -= dirX, y -= dirY)
+            {
+                if (m_live.test(x, y) || !canPushFrom(walls, x, y, dirX, dirY))
+                    continue;
+                m_live.set(x, y, true);
+                queue.push_back(y * columns + x);
+            }
+        }
+    }
+}
+
+bool DeadlockDetector::isDeadlocked(const BoardMasks& masks, Scratch& scratch) const
+{
+    if (!isBuilt())
+        return false;
+
+    const int columns = masks.getColumns();
+    const int rows = masks.getRows();
+    BitGrid& frozen = scratch.frozen;
+    BitGrid& blocked = scratch.blocked;
+    if (frozen.getColumns() != columns || frozen.getRows() != rows)
+    {
+        frozen = BitGrid(columns, rows);
+        blocked = BitGrid(columns, rows);
+    }
+
+    // Start from every object frozen and thaw any that could move with only walls and frozen objects in the way
+    std::vector<uint64_t>& frozenWords = frozen.getWords();
+    std::vector<uint64_t>& blockedWords = blocked.getWords();
+    const std::vector<uint64_t>& wallWords = masks.getWalls().getWords();
+    const std::vector<uint64_t>& occupiedWords = masks.getOccupied().getWords();
+    for (size_t i = 0; i < frozenWords.size(); ++i)
+        frozenWords[i] = occupiedWords[i] & ~wallWords[i];
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (size_t i = 0; i < blockedWords.size(); ++i)
+            blockedWords[i] = wallWords[i] | frozenWords[i];
+
+        for (int y = 0; y < rows; ++y)
+        {
+            for (int x = frozen.findNextSet(y, 0); x < columns; x = frozen.findNextSet(y, x + 1))
+            {
+                for (const auto& direction : DIRECTIONS)
+                {
+                    if (isOpen(blocked, x + direction[0], y + direction[1]) &&
+                        canPushFrom(blocked, x, y, direction[0], direction[1]))
+                    {
+                        frozen.set(x, y, false);
+                        changed = true;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    // Goals covered by walls or frozen objects stay filled; the rest need a movable object on a live cell
+    const std::vector<uint64_t>& goalWords = masks.getGoals().getWords();
+    const std::vector<uint64_t>& liveWords = m_live.getWords();
+    int openGoals = 0;
+    int usableObjects = 0;
+    for (size_t i = 0; i < frozenWords.size(); ++i)
+    {
+        const uint64_t permanent = wallWords[i] | frozenWords[i];
+        openGoals += BitGrid::countSetBits(goalWords[i] & ~permanent);
+        usableObjects += BitGrid::countSetBits(occupiedWords[i] & ~permanent & liveWords[i]);
+    }
+    return usableObjects < openGoals;
+}
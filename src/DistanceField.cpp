@@ -0,0 +1,51 @@
+#include "DistanceField.h"
+#include <algorithm>
+#include <array>
+
+void DistanceField::build(const OccupancyGrid& grid, TileIndex root)
+{
+    const int size = grid.getSize();
+    m_distances.assign(size, -1);
+    m_nextSteps.assign(size, -1);
+    m_queue.clear();
+    m_root = root;
+    m_valid = true;
+
+    if (root < 0 || root >= size)
+        return;
+
+    // The root holds the agent itself, so it is expanded even if marked blocked
+    size_t head = 0;
+    m_distances.set(root, 0);
+    m_queue.push_back(root);
+
+    std::array<TileIndex, 4> neighbors;
+    while (head < m_queue.size())
+    {
+        TileIndex current = m_queue[head++];
+        const int distance = m_distances.get(current) + 1;
+        const int count = grid.getNeighbors(current, neighbors);
+        for (int i = 0; i < count; ++i)
+        {
+            TileIndex neighbor = neighbors[i];
+            if (grid.isBlocked(neighbor) || m_distances.get(neighbor) >= 0)
+                continue;
+
+            m_distances.set(neighbor, distance);
+            m_nextSteps.set(neighbor, current);
+            m_queue.push_back(neighbor);
+        }
+    }
+}
+
+bool DistanceField::getPathFromRoot(TileIndex target, std::vector<TileIndex>& path) const
+{
+    path.clear();
+    if (!m_valid || target < 0 || target >= m_distances.size() || !isReachable(target))
+        return false;
+
+    for (TileIndex cell = target; cell >= 0; cell = m_nextSteps.get(cell))
+        path.push_back(cell);
+    std::reverse(path.begin(), path.end());
+    return true;
+}
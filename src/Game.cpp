@@ -1,16 +1,49 @@
 #include "Game.h"
+#include <algorithm>
+#include <cmath>
 
-Game::Game(const std::string& path, const std::string& playerName) 
+namespace
+{
+    constexpr float MIN_ZOOM = 0.25f;
+    constexpr float MAX_ZOOM = 4.0f;
+    constexpr float ZOOM_STEP = 0.125f;           // Fraction of the zoom per wheel notch
+    constexpr float PAN_SPEED = 800.0f;           // Screen pixels per second with the arrow keys
+
+    // Tiles overlapping a world-space area, clamped to the board
+    TileRange getOverlappedTiles(Rectangle area, int columns, int rows)
+    {
+        const float size = static_cast<float>(Tile::getSize());
+        return {
+            std::max(static_cast<int>(std::floor(area.x / size)), 0),
+            std::max(static_cast<int>(std::floor(area.y / size)), 0),
+            std::min(static_cast<int>(std::ceil((area.x + area.width) / size)), columns),
+            std::min(static_cast<int>(std::ceil((area.y + area.height) / size)), rows)
+        };
+    }
+}
+
+Game::Game(const std::string& path, const std::string& playerName, GameBoard::LoadMode mode)
 {
     // Initialize Raylib
     InitWindow(1000, 1000, "TilePuzzle");
     SetTargetFPS(60);
 
-    m_gameBoard = GameBoard(path, playerName);
+    // Pack every sprite image into one texture before any sprite exists
+    SpriteFactory::buildAtlas();
+
+    m_gameBoard = GameBoard(path, playerName, mode);
     m_renderer = Renderer();
 
-    for (auto& sprite : m_gameBoard.getTiles())
-        m_backgroundSprites.push_back(sprite);
+    // Boards small enough for the background cache are loaded whole; larger ones load chunks as they come into view,
+    // since every loaded tile costs a sprite. Streamed boards always draw what is in view, since their chunks come and go
+    const int columns = m_gameBoard.getBoardColumns();
+    const int rows = m_gameBoard.getBoardRows();
+    if (!m_gameBoard.isStreamed() && BackgroundCache::fits(columns, rows))
+    {
+        m_gameBoard.loadTiles({ 0, 0, columns, rows });
+        m_useTilemap = m_tilemap.build(m_gameBoard.getTileGrid());
+        m_background.build(columns, rows);
+    }
 
     for (auto& sprite : m_gameBoard.getResidingSprites())
         m_foregroundSprites.push_back(sprite);
@@ -20,25 +53,165 @@ Game::Game(const std::string& path, const std::string& playerName)
 
 void Game::run()
 {
+    m_stepStart = GetTime();
     while (!WindowShouldClose())
     {
+        // Steps are timed here rather than by GetFrameTime, which only updates in EndDrawing and
+        // would hand a whole sleep to the frame drawn after waking
+        const double now = GetTime();
+        m_deltaTime = now - m_stepStart;
+        m_stepStart = now;
+
         handleInputEvents();
+        update(m_deltaTime);
+        m_gameBoard.updateStreaming(m_gameBoard.getVisibleTiles(m_camera, GetScreenWidth(), GetScreenHeight()));
+        updateGround();
 
-        double deltaTime = GetFrameTime();
-        update(deltaTime);
+        // Only tiles that changed are re-rendered into the cached background
+        if (m_background.isReady())
+        {
+            m_background.sync(m_gameBoard.getTileGrid(), m_foregroundSprites, m_liveSprites);
+            m_background.redraw([this](Rectangle area)
+            {
+                // Only the run's own tiles; the rest of the board is clipped away anyway
+                drawGround(getOverlappedTiles(area, m_gameBoard.getBoardColumns(), m_gameBoard.getBoardRows()));
+                for (const auto& sprite : m_background.getBakedSprites())
+                {
+                    if (CheckCollisionRecs(sprite->getRect(), area))
+                        m_renderer.submit(*sprite, 1);
+                }
+                m_renderer.flush();
+            });
+        }
+
+        // Nothing moved and nothing is pending: block in the event poll instead of drawing
+        if (m_eventDriven && !hasActivity())
+        {
+            EnableEventWaiting();
+            PollInputEvents();
+            DisableEventWaiting();
+
+            // Time spent asleep is not part of any step
+            m_stepStart = GetTime();
+            continue;
+        }
+        m_firstFrame = false;
 
         BeginDrawing();
         ClearBackground(RAYWHITE);
+        BeginMode2D(m_camera);
 
-        m_renderer.renderAll(m_backgroundSprites);
-        m_renderer.renderAll(m_foregroundSprites);
+        // A static board is one blit; only walking sprites are drawn over it
+        if (m_background.isReady())
+        {
+            m_background.draw();
+            m_renderer.submitAll(m_liveSprites, 1);
+        }
+        else
+        {
+            drawVisible();
+        }
+        m_renderer.flush();
+        EndMode2D();
         EndDrawing();
     }
     CloseWindow();
 }
 
+bool Game::hasActivity() const
+{
+    if (m_firstFrame || m_inputChanged || IsWindowResized() || m_gameBoard.isBusy())
+        return true;
+
+    // Modifier changes and pushes show up as tiles the background cache had to redraw
+    if (m_background.isReady())
+        return m_background.getLastRedrawCount() > 0 || !m_liveSprites.empty();
+    return std::any_of(m_foregroundSprites.begin(), m_foregroundSprites.end(),
+                       [](const std::shared_ptr<Sprite>& sprite) { return sprite->isMoving(); });
+}
+
+void Game::updateGround()
+{
+    // Painted tiles are replaced, so the board's tiles are read live
+    const TileGrid& tiles = m_gameBoard.getTileGrid();
+    if (m_useTilemap && !m_tilemap.update(tiles))
+        m_useTilemap = m_tilemap.build(tiles);
+}
+
+void Game::drawGround(const TileRange& range)
+{
+    // One quad for the ground; only tinted tiles, such as the hovered one, are drawn again on top
+    if (m_useTilemap)
+        m_tilemap.draw();
+    m_gameBoard.loadTiles(range);
+    for (int y = range.top; y < range.bottom; ++y)
+    {
+        for (int x = range.left; x < range.right; ++x)
+        {
+            const std::shared_ptr<Tile>& tile = m_gameBoard.getTile(x, y);
+            const Vector4& offset = tile->getColorOffset();
+            if (!m_useTilemap || offset.x != 0.0f || offset.y != 0.0f || offset.z != 0.0f || offset.w != 0.0f)
+                m_renderer.submit(*tile, 0);
+        }
+    }
+}
+
+void Game::drawVisible()
+{
+    // Boards too large to cache are culled to the tiles in view, and the sprites overlapping them
+    const TileRange range = m_gameBoard.getVisibleTiles(m_camera, GetScreenWidth(), GetScreenHeight());
+    drawGround(range);
+
+    const float size = static_cast<float>(Tile::getSize());
+    const Rectangle view = {
+        range.left * size, range.top * size,
+        (range.right - range.left) * size, (range.bottom - range.top) * size
+    };
+    m_visibleSprites.clear();
+    m_gameBoard.getSpriteIndex().query(view, m_visibleSprites);
+    m_renderer.submitAll(m_visibleSprites, 1);
+}
+
+bool Game::handleCamera()
+{
+    const Camera2D previous = m_camera;
+
+    // Zoom around the cursor so the point under it stays put
+    const float wheel = GetMouseWheelMove();
+    if (wheel != 0.0f)
+    {
+        const Vector2 mouse = GetMousePosition();
+        m_camera.target = GetScreenToWorld2D(mouse, m_camera);
+        m_camera.offset = mouse;
+        m_camera.zoom = std::clamp(m_camera.zoom * (1.0f + ZOOM_STEP * wheel), MIN_ZOOM, MAX_ZOOM);
+    }
+
+    // Drag with the middle button or pan with the arrow keys; both move in screen pixels
+    Vector2 pan{};
+    if (IsMouseButtonDown(MOUSE_BUTTON_MIDDLE))
+        pan = GetMouseDelta();
+    const float step = PAN_SPEED * static_cast<float>(m_deltaTime);
+    pan.x += (IsKeyDown(KEY_LEFT) - IsKeyDown(KEY_RIGHT)) * step;
+    pan.y += (IsKeyDown(KEY_UP) - IsKeyDown(KEY_DOWN)) * step;
+    m_camera.target.x -= pan.x / m_camera.zoom;
+    m_camera.target.y -= pan.y / m_camera.zoom;
+
+    m_gameState.camera = m_camera;
+    return m_camera.zoom != previous.zoom || m_camera.target.x != previous.target.x ||
+           m_camera.target.y != previous.target.y || m_camera.offset.x != previous.offset.x ||
+           m_camera.offset.y != previous.offset.y;
+}
+
 void Game::handleInputEvents()
 {
+    const bool cameraMoved = handleCamera();
+
+    // Hovering a new tile changes highlights; moves within a tile change nothing on screen
+    const int hoveredTile = m_gameBoard.getEnclosingTile(GetMousePosition(), m_camera).index;
+    m_inputChanged = cameraMoved || hoveredTile != m_hoveredTile ||
+                     IsMouseButtonPressed(MOUSE_BUTTON_LEFT) || IsMouseButtonPressed(MOUSE_BUTTON_RIGHT);
+    m_hoveredTile = hoveredTile;
+
     if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT))
     {
         Vector2 mousePosition = GetMousePosition();
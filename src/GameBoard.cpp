@@ -1,160 +1,294 @@
 #include "GameBoard.h"
 
-GameBoard::GameBoard(const std::string& path, const std::string& playerName)
-{
-    readDimensions(path);
-    
-    // Reserve space in vectors
-    m_tiles.reserve(m_boardRows);
-    for (auto& row : m_tiles)
-        row.reserve(m_boardColumns);
-
-    m_residingSprites.reserve((m_boardRows * m_boardColumns) / 2); // Estimate of how many sprites are on the board
-
-    // Determine offsets for matrices in the file
-    int offset = 1; // First line is dimensions
-    Matrix tileKeys = loadMatrix(path, offset, m_boardRows, m_boardColumns);
-    offset += m_boardRows;
-    Matrix immovableKeys = loadMatrix(path, offset, m_boardRows, m_boardColumns);
-    offset += m_boardRows;
-    Matrix movableKeys = loadMatrix(path, offset, m_boardRows, m_boardColumns);
-
-    // Lay tiles on the board
-    for (int i = 0; i < tileKeys.size(); ++i)
+GameBoard::GameBoard(const std::string& path, const std::string& playerName, LoadMode mode)
+{
+    m_asyncPathfinder = std::make_unique<AsyncPathfinder>();
+    SpriteFactory::initialize();
+    if (mode == LoadMode::Streamed)
+        openStreamed(path);
+    else
+        openLevel(LevelData::load(path));
+    m_player = SpriteFactory::create<Sprite>(playerName, 100.0f);
+    m_spriteIndex.update(m_player, m_player->getRect());
+
+    // Flat searches grow with the board, so large and streamed boards route clicks through the
+    // cluster graph, which the worker builds while the level starts up
+    if (m_streamer || m_tiles.getSize() > getMaxFlatPathCells())
     {
-        std::vector<std::shared_ptr<Tile>> convertedRow;
-        for (int j = 0; j < tileKeys[i].size(); ++j)
+        m_pathMode = PathMode::Hierarchical;
+        m_asyncPathfinder->prepare(getOccupancySnapshot());
+    }
+}
+
+void GameBoard::allocateGrids()
+{
+    m_tiles = TileGrid(m_boardColumns, m_boardRows);
+    m_occupancy = OccupancyGrid(m_boardColumns, m_boardRows);
+    m_masks = BoardMasks(m_boardColumns, m_boardRows);
+    m_zobrist = ZobristTable(m_boardColumns * m_boardRows);
+}
+
+void GameBoard::openLevel(const LevelData& level)
+{
+    readDimensions(level);
+    allocateGrids();
+
+    // Levels paint materials; the auto-tiler turns them into solid and border tiles in one pass
+    m_autoTiler = AutoTiler(m_boardColumns, m_boardRows);
+    for (int i = 0; i < m_boardRows; ++i)
+    {
+        for (int j = 0; j < m_boardColumns; ++j)
+            m_autoTiler.setMaterial(j, i, level.getTileKey(j, i));
+    }
+    m_autoTiler.retileAll();
+
+    // Tiles themselves are created a chunk at a time when first used; matrix rows map to y and columns map to x
+    for (int i = 0; i < m_boardRows; ++i)
+    {
+        for (int j = 0; j < m_boardColumns; ++j)
         {
-            const std::string& textureKey = tileKeys[i][j];
-            std::shared_ptr<Tile> tile = SpriteFactory::create<Tile>(textureKey);
-            tile->setWindowCoordinates(i * Tile::getSize(), j * Tile::getSize());
-            tile->setRotation(90.0f * generateRandomRotation(i, j));
-            convertedRow.push_back(tile);
+            if (!level.isGoal(j, i))
+                continue;
+            m_masks.setGoal(j, i, true);
+            ++m_unfilledGoals;
         }
-        m_tiles.push_back(convertedRow);
     }
 
     // Place immovable objects
-    for (int i = 0; i < immovableKeys.size(); ++i)
+    for (int i = 0; i < m_boardRows; ++i)
     {
-        for (int j = 0; j < immovableKeys[i].size(); ++j)
+        for (int j = 0; j < m_boardColumns; ++j)
         {
-            const std::string& textureKey = immovableKeys[i][j];
-            if (textureKey == "Empty")
+            if (!level.hasImmovable(j, i))
                 continue;
 
-            auto sprite = SpriteFactory::create<Sprite>(textureKey);
-            auto tile = getTile(i, j);
-            sprite->setGameBoardCoordinates(i, j);
-            tile->setResidingSprite(sprite);
+            auto sprite = SpriteFactory::create<Sprite>(level.getImmovableKey(j, i));
+            sprite->setGameBoardCoordinates(j, i);
+            setResidingSprite(m_tiles.toIndex(j, i), sprite);
+            m_spriteIndex.update(sprite, sprite->getRect());
+            m_masks.setWall(j, i, true);
             m_residingSprites.push_back(sprite);
         }
     }
 
     // Place movable objects
-    for (int i = 0; i < movableKeys.size(); ++i)
+    int movableCount = 0;
+    for (int i = 0; i < m_boardRows; ++i)
     {
-        for (int j = 0; j < movableKeys[i].size(); ++j)
+        for (int j = 0; j < m_boardColumns; ++j)
         {
-            const std::string& textureKey = movableKeys[i][j];
-            if (textureKey == "Empty")
+            if (!level.hasMovable(j, i))
                 continue;
 
-            auto sprite = SpriteFactory::create<Sprite>(textureKey, 5.0f);
-            auto tile = getTile(i, j);
-            sprite->setGameBoardCoordinates(i, j);
-            tile->setResidingSprite(sprite);
+            auto sprite = SpriteFactory::create<Sprite>(level.getMovableKey(j, i), 5.0f);
+            sprite->setGameBoardCoordinates(j, i);
+            setResidingSprite(m_tiles.toIndex(j, i), sprite);
+            m_spriteIndex.update(sprite, sprite->getRect());
             m_residingSprites.push_back(sprite);
+            ++movableCount;
         }
     }
+    m_deadlocks.build(m_masks, movableCount);
+}
 
-    m_player = SpriteFactory::create<Sprite>(playerName, 100.0f);
+void GameBoard::openStreamed(const std::string& path)
+{
+    m_streamer = std::make_unique<ChunkStreamer>(path, TileGrid::getChunkSize(), getMaxColumns(), getMaxRows());
+    setDimensions(m_streamer->getRows(), m_streamer->getColumns());
+    allocateGrids();
+
+    // Goals and objects come from the file's bit summaries; tiles and sprites wait for their chunks
+    const BitGrid& goals = m_streamer->getGoals();
+    const BitGrid& immovables = m_streamer->getImmovables();
+    const BitGrid& movables = m_streamer->getMovables();
+    for (int y = 0; y < m_boardRows; ++y)
+    {
+        for (int x = goals.findNextSet(y, 0); x < m_boardColumns; x = goals.findNextSet(y, x + 1))
+        {
+            m_masks.setGoal(x, y, true);
+            ++m_unfilledGoals;
+        }
+    }
+    for (int y = 0; y < m_boardRows; ++y)
+    {
+        for (int x = immovables.findNextSet(y, 0); x < m_boardColumns; x = immovables.findNextSet(y, x + 1))
+        {
+            m_masks.setWall(x, y, true);
+            setBlocked(m_tiles.toIndex(x, y), true);
+        }
+        for (int x = movables.findNextSet(y, 0); x < m_boardColumns; x = movables.findNextSet(y, x + 1))
+        {
+            if (immovables.test(x, y))
+                continue;
+            setBlocked(m_tiles.toIndex(x, y), true);
+        }
+    }
+
+    // Dead cells and frozen objects are found by searches over the whole world, which a streamed
+    // board exists to avoid; without a table its pushes are never reported as deadlocks
+}
+
+void GameBoard::loadStreamedChunk(const ChunkStreamer::ChunkData& data) const
+{
+    // Unpinned chunks still match the file, so their objects are exactly where the file puts them
+    const TileRange range{ data.left, data.top, data.left + data.width, data.top + data.height };
+    m_tiles.load(range, [this, &data](int x, int y)
+    {
+        const int slot = data.toSlot(x, y);
+        return createTile(x, y, data.tileKeys[slot], data.borders[slot]);
+    });
+    for (int y = range.top; y < range.bottom; ++y)
+    {
+        for (int x = range.left; x < range.right; ++x)
+        {
+            const int slot = data.toSlot(x, y);
+            std::shared_ptr<Sprite> sprite;
+            if (data.immovableKeys[slot] != LevelData::getEmptyKey())
+                sprite = SpriteFactory::create<Sprite>(data.immovableKeys[slot]);
+            else if (data.movableKeys[slot] != LevelData::getEmptyKey())
+                sprite = SpriteFactory::create<Sprite>(data.movableKeys[slot], 5.0f);
+            if (!sprite)
+                continue;
+            sprite->setGameBoardCoordinates(x, y);
+            m_tiles.setResidingSprite(m_tiles.toIndex(x, y), sprite);
+            m_spriteIndex.update(sprite, sprite->getRect());
+        }
+    }
+    m_streamer->markResident(data.chunk);
+}
+
+void GameBoard::updateStreaming(const TileRange& view)
+{
+    if (!m_streamer)
+        return;
+
+    // The view plus a ring of chunks to prefetch, then the surroundings of the player and every agent
+    const int size = TileGrid::getChunkSize();
+    const int chunkColumns = m_streamer->getChunkColumns();
+    const int chunkRows = (m_boardRows + size - 1) / size;
+    m_wantedChunks.clear();
+    auto want = [&](int left, int top, int right, int bottom)
+    {
+        for (int y = std::max(top, 0); y <= std::min(bottom, chunkRows - 1); ++y)
+        {
+            for (int x = std::max(left, 0); x <= std::min(right, chunkColumns - 1); ++x)
+                m_wantedChunks.push_back(y * chunkColumns + x);
+        }
+    };
+    if (!view.isEmpty())
+        want(view.left / size - 1, view.top / size - 1, (view.right - 1) / size + 1, (view.bottom - 1) / size + 1);
+    auto wantAround = [&](const std::shared_ptr<Sprite>& sprite)
+    {
+        const Vector2 position = sprite->getWindowCoordinates();
+        const int x = std::clamp(static_cast<int>(position.x / Tile::getSize()), 0, m_boardColumns - 1) / size;
+        const int y = std::clamp(static_cast<int>(position.y / Tile::getSize()), 0, m_boardRows - 1) / size;
+        want(x - 1, y - 1, x + 1, y + 1);
+    };
+    wantAround(m_player);
+    for (const std::shared_ptr<Sprite>& agent : m_agents)
+        wantAround(agent);
+
+    m_streamer->update(m_wantedChunks, m_readyChunks, m_evictedChunks);
+    for (const std::shared_ptr<const ChunkStreamer::ChunkData>& data : m_readyChunks)
+    {
+        if (!m_tiles.isLoaded(data->left, data->top))
+            loadStreamedChunk(*data);
+    }
+    for (int chunk : m_evictedChunks)
+    {
+        // Evicted chunks are unpinned, so their residents never left them
+        const int left = (chunk % chunkColumns) * size;
+        const int top = (chunk / chunkColumns) * size;
+        m_evictedSprites.clear();
+        m_tiles.collectResidingSprites({ left, top, left + size, top + size }, m_evictedSprites);
+        for (const std::shared_ptr<Sprite>& sprite : m_evictedSprites)
+            m_spriteIndex.remove(sprite);
+        m_tiles.unload(left, top);
+    }
+    m_readyChunks.clear();
 }
 
-void GameBoard::readDimensions(const std::string& path)
+void GameBoard::setStreamingBudget(size_t bytes)
 {
-    std::ifstream file(path);
-    if (!file.is_open())
-        throw std::runtime_error("Could not open file: " + path);
+    if (m_streamer)
+        m_streamer->setChunkBudget(static_cast<int>(std::max<size_t>(bytes / TileGrid::getChunkBytes(), 1)));
+}
+
+void GameBoard::readDimensions(const LevelData& level)
+{
+    setDimensions(level.getRows(), level.getColumns());
+}
 
-    std::string line;
-    std::getline(file, line);
-    std::stringstream dimensionsStream(line);
-    dimensionsStream >> m_boardRows;
-    dimensionsStream.ignore(1);
-    dimensionsStream >> m_boardColumns;
+void GameBoard::setDimensions(int rows, int columns)
+{
+    m_boardRows = rows;
+    m_boardColumns = columns;
 
-    if (m_boardRows <= 0 || m_boardColumns <= 0 || 
-            m_boardRows > getMaxRows() || 
-            m_boardColumns > getMaxColumns())
-        throw std::runtime_error("Invalid board dimensions in file: " + path);
+    if (m_boardRows <= 0 || m_boardColumns <= 0 || m_boardRows > getMaxRows() || m_boardColumns > getMaxColumns())
+        throw std::runtime_error("Invalid board dimensions: " + std::to_string(m_boardRows) +
+                                 "," + std::to_string(m_boardColumns));
 
     m_boardBounds =
     {
-        static_cast<float>(m_boardRows * Tile::getSize() - 5),
-        static_cast<float>(m_boardColumns * Tile::getSize() - 5)
+        static_cast<float>(m_boardColumns * Tile::getSize() - 5),
+        static_cast<float>(m_boardRows * Tile::getSize() - 5)
     };
 }
 
-std::vector<std::vector<std::string>> GameBoard::loadMatrix(const std::string& path,
-    int offset, int expectedRows, int expectedColumns)
+std::shared_ptr<Tile> GameBoard::createTile(int x, int y) const
 {
-    std::ifstream file(path);
-    if (!file.is_open())
-        throw std::runtime_error("Could not open file: " + path);
+    return createTile(x, y, m_autoTiler.getTileKey(x, y), m_autoTiler.getBorder(x, y));
+}
 
-    // Skip lines up to the matrix start
-    std::string line;
-    for (int i = 0; i < offset; ++i)
+std::shared_ptr<Tile> GameBoard::createTile(int x, int y, const std::string& key, Direction::Type border) const
+{
+    std::shared_ptr<Tile> tile = SpriteFactory::create<Tile>(key);
+    tile->setWindowCoordinates(x * Tile::getSize(), y * Tile::getSize());
+
+    // Border art is drawn for one orientation; only solid tiles get a random turn
+    if (border == Direction::NONE)
+        tile->setRotation(90.0f * generateRandomRotation(y, x));
+    if (m_masks.isGoal(x, y))
+        tile->setAsGoalTile();
+    return tile;
+}
+
+void GameBoard::loadTiles(const TileRange& range) const
+{
+    if (!m_streamer)
     {
-        if (!std::getline(file, line))
-            throw std::runtime_error("Unexpected end of file before matrix data");
+        m_tiles.load(range, [this](int x, int y) { return createTile(x, y); });
+        return;
     }
 
-    // Read the matrix
-    std::vector<std::vector<std::string>> matrix;
-    for (int i = 0; i < expectedRows; ++i)
+    // Chunks the worker hasn't delivered yet are read on the spot
+    const int size = TileGrid::getChunkSize();
+    for (int y = range.top - range.top % size; y < range.bottom; y += size)
     {
-        // Skip lines that contain only whitespace or invisible characters
-        do {
-            if (!std::getline(file, line))
-                throw std::runtime_error("Unexpected end of file in matrix data");
-        } while (line.find_first_not_of(" \t\n\r") == std::string::npos);
-
-        std::vector<std::string> rowElements;
-        std::stringstream ss(line);
-        std::string cell;
-
-        // Parse the line as a CSV row
-        while (std::getline(ss, cell, ','))
+        for (int x = range.left - range.left % size; x < range.right; x += size)
         {
-            // Trim whitespace around the cell if necessary
-            cell.erase(cell.find_last_not_of(" \t\n\r") + 1);
-            cell.erase(0, cell.find_first_not_of(" \t\n\r"));
-            rowElements.push_back(cell);
+            if (!m_tiles.isLoaded(x, y))
+                loadStreamedChunk(*m_streamer->read(m_streamer->toChunk(x, y)));
         }
-
-        // Validate the row size
-        int size = static_cast<int>(rowElements.size());
-        if (size != expectedColumns)
-        {
-            throw std::runtime_error(
-                "Row size mismatch in matrix data; row size: " + std::to_string(size) +
-                ", expected: " + std::to_string(expectedColumns));
-        }
-
-        matrix.push_back(rowElements);
     }
+}
 
-    // Validate the number of rows read
-    if (static_cast<int>(matrix.size()) != expectedRows)
+void GameBoard::paintTile(int x, int y, const std::string& material)
+{
+    // Streamed levels keep no per-cell materials to re-tile from
+    if (m_streamer)
+        throw std::logic_error("paintTile: Not available on a streamed board");
+    m_autoTiler.paint(x, y, material, m_retiledCells);
+    for (TileIndex cell : m_retiledCells)
     {
-        throw std::runtime_error(
-            "Row count mismatch in matrix data; rows read: " + std::to_string(matrix.size()) +
-            ", expected: " + std::to_string(expectedRows));
+        // Chunks not created yet pick the new tile up from the auto-tiler when they are
+        const std::shared_ptr<Tile>& previous = m_tiles.findTile(cell);
+        if (!previous)
+            continue;
+        std::shared_ptr<Tile> tile = createTile(cell % m_boardColumns, cell / m_boardColumns);
+        tile->setResidingSprite(previous->getResidingSprite());
+        m_tiles.setTile(cell, std::move(tile));
     }
-
-    return matrix;
 }
 
 int GameBoard::generateRandomRotation(int x, int y) const
@@ -165,42 +299,164 @@ int GameBoard::generateRandomRotation(int x, int y) const
     return dist(rng);
 }
 
-std::shared_ptr<Tile> GameBoard::getEnclosingTile(const std::shared_ptr<Sprite>& sprite) const
+TileHandle GameBoard::getEnclosingTile(const std::shared_ptr<Sprite>& sprite) const
 {
     return getEnclosingTile(sprite->getWindowCoordinates());
 }
 
-std::shared_ptr<Tile> GameBoard::getEnclosingTile(Vector2 windowCoordinates) const
+TileHandle GameBoard::getEnclosingTile(Vector2 windowCoordinates) const
 {
-    Vector2 gameBoardCoordinates = CoordinateTransformer::toGameBoardCoordinates(windowCoordinates);
+    int x = static_cast<int>(std::floor(windowCoordinates.x / Tile::getSize()));
+    int y = static_cast<int>(std::floor(windowCoordinates.y / Tile::getSize()));
 
-    if (gameBoardCoordinates.x < 0 || gameBoardCoordinates.y < 0 ||
-        gameBoardCoordinates.x >= m_boardColumns || gameBoardCoordinates.y >= m_boardRows)
-    {
+    if (!m_tiles.contains(x, y))
         throw std::out_of_range("getEnclosingTile: Sprite is out of board bounds.");
-    }
 
-    return m_tiles[static_cast<int>(gameBoardCoordinates.x)][static_cast<int>(gameBoardCoordinates.y)];
+    return m_tiles.getHandle(m_tiles.toIndex(x, y));
+}
+
+TileHandle GameBoard::getEnclosingTile(Vector2 screenCoordinates, const Camera2D& camera) const
+{
+    const Vector2 world = GetScreenToWorld2D(screenCoordinates, camera);
+    return m_tiles.getHandle(static_cast<int>(std::floor(world.x / Tile::getSize())),
+                             static_cast<int>(std::floor(world.y / Tile::getSize())));
+}
+
+TileRange GameBoard::getVisibleTiles(const Camera2D& camera, int screenWidth, int screenHeight) const
+{
+    // Corners are enough without rotation; one tile of margin covers sprites hanging over an edge
+    const Vector2 topLeft = GetScreenToWorld2D({ 0.0f, 0.0f }, camera);
+    const Vector2 bottomRight = GetScreenToWorld2D({ static_cast<float>(screenWidth), static_cast<float>(screenHeight) }, camera);
+    const float size = static_cast<float>(Tile::getSize());
+    TileRange range;
+    range.left = std::max(static_cast<int>(std::floor(topLeft.x / size)) - 1, 0);
+    range.top = std::max(static_cast<int>(std::floor(topLeft.y / size)) - 1, 0);
+    range.right = std::min(static_cast<int>(std::ceil(bottomRight.x / size)) + 1, m_boardColumns);
+    range.bottom = std::min(static_cast<int>(std::ceil(bottomRight.y / size)) + 1, m_boardRows);
+    return range;
+}
+
+void GameBoard::collectResidingSprites(const TileRange& range, std::vector<std::shared_ptr<Sprite>>& sprites) const
+{
+    m_tiles.collectResidingSprites(range, sprites);
 }
 
 void GameBoard::onClick(const GameState& state)
 {
-    if (state.mousePosition.x > m_boardBounds.x || state.mousePosition.y > m_boardBounds.y)
+    TileHandle destinationTile = getEnclosingTile(state.mousePosition, state.camera);
+    if (!destinationTile.isValid())
+        return;
+
+    // Occupied destinations are rejected; only open tiles can be walked to
+    if (m_occupancy.isBlocked(destinationTile.index))
+        return;
+
+    // A current distance field answers instantly, and rejects unreachable tiles without searching
+    TileIndex playerTile = getEnclosingTile(m_player).index;
+    if (m_playerField.isValidFor(playerTile))
+    {
+        m_asyncPathfinder->cancel();
+        m_pathTicket = 0;
+        if (m_playerField.getPathFromRoot(destinationTile.index, m_path))
+            startPlayerRoute(destinationTile.index, false);
+        return;
+    }
+
+    // A flood fill over the bitmasks rules out unreachable tiles before any search is queued; the
+    // cluster graph does the same per component on the worker, without touching every tile
+    if (m_pathMode != PathMode::Hierarchical && !isReachable(playerTile, destinationTile.index))
+        return;
+
+    // Otherwise search off the render thread; a newer click supersedes this one
+    m_pendingSnapshot = getOccupancySnapshot();
+    m_pendingGoal = destinationTile.index;
+    m_pathTicket = m_asyncPathfinder->submit(m_pendingSnapshot, playerTile, destinationTile.index, m_pathMode);
+}
+
+void GameBoard::startPlayerRoute(TileIndex goal, bool stale)
+{
+    // The planner only searches again once the occupancy changes under the player
+    m_playerTile = m_path.front();
+    m_playerPlanner.initialize(m_occupancy, m_playerTile, goal);
+    m_replanPending = stale;
+    walkPlayerPath(m_path);
+}
+
+void GameBoard::pollPathRequest()
+{
+    if (m_pathTicket == 0)
+        return;
+
+    AsyncPathfinder::Status status = m_asyncPathfinder->poll(m_pathTicket, m_path);
+    if (status == AsyncPathfinder::Status::Pending)
+        return;
+
+    // A result computed on an outdated snapshot is still walked, but repaired right away
+    if (status == AsyncPathfinder::Status::Found)
+        startPlayerRoute(m_pendingGoal, m_pendingSnapshot != m_snapshot);
+
+    m_pathTicket = 0;
+    m_pendingSnapshot.reset();
+}
+
+std::shared_ptr<const OccupancyGrid> GameBoard::getOccupancySnapshot() const
+{
+    if (!m_snapshot)
+        m_snapshot = std::make_shared<const OccupancyGrid>(m_occupancy);
+    return m_snapshot;
+}
+
+const DistanceField& GameBoard::getPlayerField() const
+{
+    TileIndex playerTile = getEnclosingTile(m_player).index;
+    if (!m_playerField.isValidFor(playerTile))
+        m_playerField.build(m_occupancy, playerTile);
+    return m_playerField;
+}
+
+const std::vector<TileIndex>& GameBoard::getPathPreview() const
+{
+    return m_pathPreview;
+}
+
+void GameBoard::walkPlayerPath(const std::vector<TileIndex>& path)
+{
+    m_pathCoordinates.clear();
+    for (TileIndex index : path)
+    {
+        const TileHandle handle = m_tiles.getHandle(index);
+        m_pathCoordinates.push_back({ static_cast<float>(handle.x), static_cast<float>(handle.y) });
+    }
+    m_player->walkPath(m_pathCoordinates);
+}
+
+void GameBoard::updatePlayerPlan()
+{
+    if (!m_playerPlanner.isActive())
         return;
 
-    std::shared_ptr<Tile> destinationTile = getEnclosingTile(state.mousePosition);
+    TileIndex playerTile = getEnclosingTile(m_player).index;
+    if (playerTile != m_playerTile)
+    {
+        m_playerTile = playerTile;
+        m_playerPlanner.updateStart(m_occupancy, playerTile);
+    }
 
-    // Unoccupied destination tile
-    if (destinationTile->getResidingSprite() == nullptr)
+    if (playerTile == m_playerPlanner.getGoal())
     {
-        std::shared_ptr<Tile> playerTile = getEnclosingTile(m_player);
-        std::vector<std::shared_ptr<Tile>> tilePath = getPathToTile(playerTile, destinationTile);
-        std::vector<Vector2> coordinates;
-        coordinates.reserve(tilePath.size());
-        for (const auto& tile : tilePath) 
-            coordinates.push_back(tile->getGameBoardCoordinates());
-        m_player->walkPath(coordinates);
+        m_playerPlanner.reset();
+        m_replanPending = false;
+        return;
     }
+
+    // Only repair the search when the occupancy changed under the walking player
+    if (!m_replanPending)
+        return;
+
+    m_replanPending = false;
+    m_playerPlanner.computeShortestPath(m_occupancy);
+    m_playerPlanner.extractPath(m_occupancy, m_path);
+    walkPlayerPath(m_path);
 }
 
 std::shared_ptr<Sprite> GameBoard::getPlayer() const 
@@ -210,37 +466,132 @@ std::shared_ptr<Sprite> GameBoard::getPlayer() const
 
 void GameBoard::update(const GameState& state)
 {
+    m_player->update(state);
+    m_spriteIndex.update(m_player, m_player->getRect());
+    pollPathRequest();
+    updatePlayerPlan();
+    updateAgents(state.deltaTime);
+
     //TODO:: Clean up update function
-    if (state.mousePosition.x > m_boardBounds.x)
+    TileHandle hoveredHandle = getEnclosingTile(state.mousePosition, state.camera);
+    if (!hoveredHandle.isValid())
         return;
+    if (m_tiles.getSize() <= getMaxPreviewCells())
+        getPlayerField().getPathFromRoot(hoveredHandle.index, m_pathPreview);
+    else
+        m_pathPreview.clear();
+
+    // Sprites are picked by their bounds, so walking ones are found between tiles too
+    std::shared_ptr<Sprite> hovered = m_spriteIndex.pick(GetScreenToWorld2D(state.mousePosition, state.camera));
+    if (!hovered)
+        hovered = getTile(hoveredHandle.index);
+    if (hovered != m_hoveredSprite)
+    {
+        hovered->onFocus();
+        if (m_hoveredSprite)
+            m_hoveredSprite->onBlur();
+        m_hoveredSprite = hovered;
+    }
+}
+
+void GameBoard::setResidingSprite(TileIndex index, const std::shared_ptr<Sprite>& sprite)
+{
+    getTile(index);                               // Residents live on tiles, so the chunk has to exist
+    m_tiles.setResidingSprite(index, sprite);
 
-    if (state.mousePosition.y > m_boardBounds.y)
+    // The chunk no longer matches the file, so it must never be evicted and read back
+    if (m_streamer)
+    {
+        const TileHandle handle = m_tiles.getHandle(index);
+        m_streamer->pin(m_streamer->toChunk(handle.x, handle.y));
+    }
+    setBlocked(index, sprite != nullptr);
+}
+
+void GameBoard::setBlocked(TileIndex index, bool blocked)
+{
+    if (m_occupancy.isBlocked(index) == blocked)
         return;
 
-    std::shared_ptr<Tile> hoveredTile = getEnclosingTile(state.mousePosition);
-    std::shared_ptr<Sprite> residingSprite = hoveredTile->getResidingSprite();
-    if (residingSprite)
+    m_occupancy.setBlocked(index, blocked);
+    const TileHandle handle = m_tiles.getHandle(index);
+    m_masks.setOccupied(handle.x, handle.y, blocked);
+    m_occupancyHash ^= m_zobrist.getOccupiedKey(index);
+    if (m_masks.isGoal(handle.x, handle.y))
+        m_unfilledGoals += blocked ? -1 : 1;
+    m_snapshot.reset();
+    m_playerField.invalidate();
+    m_asyncPathfinder->notifyCellChanged(index);
+    if (m_playerPlanner.isActive())
     {
-        if (residingSprite != m_hoveredSprite)
-        {
-            residingSprite->onFocus();
-            if (m_hoveredSprite)
-                m_hoveredSprite->onBlur();
-            m_hoveredSprite = residingSprite;
-        }
+        m_playerPlanner.notifyCellChanged(m_occupancy, index);
+        m_replanPending = true;
     }
-    else
+
+    if (!m_movingAgents && !m_agents.empty())
+        m_agentPlanner.notifyCellChanged();
+}
+
+CooperativePlanner::AgentId GameBoard::addAgent(const std::shared_ptr<Sprite>& sprite, TileIndex goal)
+{
+    TileHandle tile = getEnclosingTile(sprite);
+    if (getTile(tile.index)->getResidingSprite() != sprite)
+        throw std::runtime_error("addAgent: Sprite does not reside on the board");
+
+    if (goal < 0 || goal >= m_tiles.getSize())
+        throw std::runtime_error("addAgent: Invalid goal");
+
+    if (m_streamer)
+        m_streamer->pin(m_streamer->toChunk(tile.x, tile.y));
+    CooperativePlanner::AgentId agent = m_agentPlanner.addAgent(m_occupancy, tile.index, goal);
+    m_agents.push_back(sprite);
+    return agent;
+}
+
+void GameBoard::setAgentGoal(CooperativePlanner::AgentId agent, TileIndex goal)
+{
+    if (goal < 0 || goal >= m_tiles.getSize())
+        throw std::runtime_error("setAgentGoal: Invalid goal");
+    m_agentPlanner.setGoal(agent, goal);
+}
+
+void GameBoard::updateAgents(float deltaTime)
+{
+    if (m_agents.empty())
+        return;
+
+    // Planning runs every frame within its budget; agents themselves move in fixed steps
+    m_agentPlanner.plan(m_occupancy);
+    m_agentStepTimer += deltaTime;
+    if (m_agentStepTimer < getAgentStepDuration())
+        return;
+    m_agentStepTimer -= getAgentStepDuration();
+
+    const std::vector<CooperativePlanner::Move>& moves = m_agentPlanner.advance(m_occupancy);
+    m_movingAgents = true;
+    for (const CooperativePlanner::Move& move : moves)
+        setResidingSprite(move.from, nullptr);
+    for (const CooperativePlanner::Move& move : moves)
     {
-        if (hoveredTile != m_hoveredSprite)
-        {
-            hoveredTile->onFocus();
-            if (m_hoveredSprite)
-                m_hoveredSprite->onBlur();
-            m_hoveredSprite = hoveredTile;
-        }
+        const TileHandle handle = m_tiles.getHandle(move.to);
+        setResidingSprite(move.to, m_agents[move.agent]);
+        m_agents[move.agent]->setGameBoardCoordinates(handle.x, handle.y);
+        m_spriteIndex.update(m_agents[move.agent], m_agents[move.agent]->getRect());
     }
+    m_movingAgents = false;
+}
 
-    m_player->update(state);
+bool GameBoard::isBusy() const
+{
+    if (m_pathTicket != 0 || m_replanPending || (m_player && m_player->isMoving()) ||
+        (m_streamer && m_streamer->isLoading()))
+        return true;
+    for (CooperativePlanner::AgentId agent = 0; agent < m_agentPlanner.getAgentCount(); ++agent)
+    {
+        if (m_agentPlanner.getPosition(agent) != m_agentPlanner.getGoal(agent))
+            return true;
+    }
+    return false;
 }
 
 void Tile::setResidingSprite(const std::shared_ptr<Sprite>& residingEntity)
@@ -253,38 +604,34 @@ std::shared_ptr<Sprite> Tile::getResidingSprite() const
     return m_residingSprite;
 }
 
-std::shared_ptr<Tile> GameBoard::getTile(int x, int y) const
+const std::shared_ptr<Tile>& GameBoard::getTile(int x, int y) const
 {
-    if (x < 0 || y < 0 || x > m_boardColumns || y > m_boardRows)
+    if (!m_tiles.contains(x, y))
         throw std::runtime_error("getTile: Invalid coordinates");
-    return m_tiles[x][y];
+    return getTile(m_tiles.toIndex(x, y));
 }
 
-std::vector<std::shared_ptr<Sprite>> GameBoard::getResidingSprites() const
+const std::shared_ptr<Tile>& GameBoard::getTile(TileIndex index) const
 {
-    return m_residingSprites;
+    if (index < 0 || index >= m_tiles.getSize())
+        throw std::runtime_error("getTile: Invalid index");
+    if (m_streamer)
+        loadTiles({ index % m_boardColumns, index / m_boardColumns, index % m_boardColumns + 1, index / m_boardColumns + 1 });
+    return m_tiles.getTile(index, [this](int x, int y) { return createTile(x, y); });
 }
 
-std::vector<std::shared_ptr<Tile>> GameBoard::getTiles() const
+std::vector<std::shared_ptr<Sprite>> GameBoard::getResidingSprites() const
 {
-    size_t totalSize = getBoardRows() * getBoardColumns();
-    std::vector<std::shared_ptr<Tile>> tiles;
-    tiles.reserve(totalSize);
-
-    for (const auto& v : m_tiles)
-        tiles.insert(tiles.end(), v.begin(), v.end());
-    return tiles;
+    return m_residingSprites;
 }
 
 void GameBoard::pushObject(const std::shared_ptr<Sprite>& object, const std::shared_ptr<Sprite>& player)
 {
-    std::shared_ptr<Tile> playerTile = getEnclosingTile(player);
-    std::shared_ptr<Tile> objectTile = getEnclosingTile(object);
-    Vector2 playerCoordinates = player->getGameBoardCoordinates();
-    Vector2 objectCoordinates = object->getGameBoardCoordinates();
+    TileHandle playerTile = getEnclosingTile(player);
+    TileHandle objectTile = getEnclosingTile(object);
 
-    int dX = playerCoordinates.x - objectCoordinates.x;
-    int dY = playerCoordinates.y - objectCoordinates.y;
+    int dX = playerTile.x - objectTile.x;
+    int dY = playerTile.y - objectTile.y;
 
     // Ensure player and object are adjacent in tile units
     if (std::abs(dX) > 1 || std::abs(dY) > 1)
@@ -316,177 +663,77 @@ void GameBoard::pushObject(const std::shared_ptr<Sprite>& object, const std::sha
     if (dirX == 0 && dirY == 0)
         return;
 
-    int x = objectCoordinates.x;
-    int y = objectCoordinates.y;
-
-    std::shared_ptr<Tile> targetTile = nullptr;
-    while (true)
-    {
-        int nextX = x + dirX;
-        int nextY = y + dirY;
-
-        // Validate board boundaries
-        if (nextX < 0 || nextX >= m_boardColumns || nextY < 0 || nextY >= m_boardRows)
-            break;
-
-        std::shared_ptr<Tile> nextTile = m_tiles[nextX][nextY];
-        if (nextTile->getResidingSprite() != nullptr)
-            break; // Cannot move further
-
-        targetTile = nextTile; // Valid target
-        x = nextX;
-        y = nextY;
-    }
+    // The first occupied cell along the row or column comes straight from a bit scan
+    const int distance = m_masks.getSlideDistance(objectTile.x, objectTile.y, dirX, dirY);
+    const int x = objectTile.x + dirX * distance;
+    const int y = objectTile.y + dirY * distance;
+    TileIndex targetIndex = m_tiles.toIndex(x, y);
 
     // If a valid target tile is found
-    if (targetTile)
+    if (targetIndex != objectTile.index)
     {
-        objectTile->setResidingSprite(nullptr);  // Clear current tile
-        targetTile->setResidingSprite(object);   // Set new tile
-        object->setGameBoardCoordinates(x, y);   // Update object position
+        // A pushed agent keeps its plan in sync instead of reading as a map change
+        auto agent = std::find(m_agents.begin(), m_agents.end(), object);
+        if (agent != m_agents.end())
+        {
+            m_agentPlanner.relocate(static_cast<CooperativePlanner::AgentId>(agent - m_agents.begin()), targetIndex);
+            m_movingAgents = true;
+        }
+
+        setResidingSprite(objectTile.index, nullptr);  // Clear current tile
+        setResidingSprite(targetIndex, object);        // Set new tile
+        object->setGameBoardCoordinates(x, y);         // Update object position
+        m_spriteIndex.update(object, object->getRect());
+        m_movingAgents = false;
+
+        // Slides can't be undone, so tell the player right away when this one lost the level
+        bool deadlocked = m_deadlocks.isDeadlocked(m_masks, m_deadlockScratch);
+        if (deadlocked && !m_deadlocked)
+            TraceLog(LOG_WARNING, "Deadlock: the remaining goals can no longer be filled");
+        m_deadlocked = deadlocked;
     }
 }
 
-std::shared_ptr<Tile> GameBoard::getClosestAvailableTile(const std::shared_ptr<Tile>& start, const std::shared_ptr<Tile>& destination) const
+TileHandle GameBoard::getClosestAvailableTile(TileHandle start, TileHandle destination) const
 {
-    constexpr int tileSize = Tile::getSize();
-    const std::array<Vector2, 4> directions = {
-        Vector2{0, -1},
-        Vector2{-1, 0},
-        Vector2{1, 0},
-        Vector2{0, 1}
-    };
+    if (!start.isValid() || !destination.isValid())
+        return {};
 
-    Vector2 startCoordinates = start->getGameBoardCoordinates();
-    int x = startCoordinates.x / tileSize;
-    int y = startCoordinates.y / tileSize;
+    if (!m_playerField.isValidFor(start.index))
+        m_playerField.build(m_occupancy, start.index);
 
-    for (const auto& dir : directions)
-    {
-        int newX = x + dir.x;
-        int newY = y + dir.y;
+    if (m_playerField.isReachable(destination.index))
+        return destination;
 
-        if (newX < 0 || newX >= m_boardColumns || newY < 0 || newY >= m_boardRows)
+    // Otherwise pick the reachable tile next to the destination that is nearest to the start
+    TileIndex closest = -1;
+    std::array<TileIndex, 4> neighbors;
+    int count = getNeighborTiles(destination.index, neighbors);
+    for (int i = 0; i < count; ++i)
+    {
+        if (!m_playerField.isReachable(neighbors[i]))
             continue;
-
-        const auto& adjacentTile = m_tiles[newX][newY];
-        if (adjacentTile && adjacentTile->getResidingSprite() == nullptr)
-            return adjacentTile;
+        if (closest < 0 || m_playerField.getDistance(neighbors[i]) < m_playerField.getDistance(closest))
+            closest = neighbors[i];
     }
-    return nullptr;
+    return closest >= 0 ? m_tiles.getHandle(closest) : TileHandle{};
 }
 
 
-std::vector<std::shared_ptr<Tile>> GameBoard::reversePath(const std::shared_ptr<AStarNode>& node)
+int GameBoard::getNeighborTiles(TileIndex tile, std::array<TileIndex, 4>& neighbors) const
 {
-    std::vector<std::shared_ptr<Tile>> path;
-    std::shared_ptr<AStarNode> current = node;
-    while (current)
-    {
-        path.push_back(current->getCorrespondingTile());
-        current = current->getParent();
-    }
-    std::reverse(path.begin(), path.end());
-    return path;
+    return m_tiles.getNeighbors(tile, neighbors);
 }
 
-float GameBoard::heuristic(const std::shared_ptr<Tile>& first, const std::shared_ptr<Tile> second)
+bool GameBoard::isReachable(TileIndex startTile, TileIndex goalTile) const
 {
-    Vector2 f = first->getGameBoardCoordinates();
-    Vector2 s = second->getGameBoardCoordinates();
-    return std::abs(f.x - s.x) + std::abs(f.y - s.y);
+    const TileHandle start = m_tiles.getHandle(startTile);
+    const TileHandle goal = m_tiles.getHandle(goalTile);
+    m_masks.fillReachable(start.x, start.y, m_reachable);
+    return m_reachable.test(goal.x, goal.y);
 }
 
-std::vector<std::shared_ptr<Tile>> GameBoard::getNeighborTiles(const std::shared_ptr<Tile>& tile) const
+uint64_t GameBoard::getStateHash() const
 {
-    static const std::array<Vector2, 4> directions =
-    {
-        Vector2{ 0, -1 },
-        Vector2{ -1, 0 },
-        Vector2{ 1, 0  },
-        Vector2{  0, 1 }
-    };
-
-    Vector2 tileCoordinate = tile->getGameBoardCoordinates();
-
-    std::vector<std::shared_ptr<Tile>> neighbors;
-    neighbors.reserve(4);
-
-    for (const auto& direction : directions)
-    {
-        Vector2 adjacentCoordinate = tileCoordinate + direction;
-        if (adjacentCoordinate.x < 0 || adjacentCoordinate.x >= m_boardColumns || 
-                adjacentCoordinate.y < 0 || adjacentCoordinate.y >= m_boardRows)
-            continue;
-        auto neighbor = m_tiles[adjacentCoordinate.x][adjacentCoordinate.y];
-        neighbors.push_back(neighbor);
-    }
-    return neighbors;
-}
-
-std::vector<std::shared_ptr<Tile>> GameBoard::getPathToTile(const std::shared_ptr<Tile>& startTile, const std::shared_ptr<Tile>& goalTile) const
-{
-    if (!startTile || !goalTile)
-        return {};
-
-    auto compare = [](const std::shared_ptr<AStarNode>& a, const std::shared_ptr<AStarNode>& b) -> bool
-    {
-        return *a > *b;
-    };
-
-    std::priority_queue<std::shared_ptr<AStarNode>, std::vector<std::shared_ptr<AStarNode>>, decltype(compare)> openList(compare);
-    std::unordered_map<std::shared_ptr<Tile>, std::shared_ptr<AStarNode>> allNodes;
-    std::unordered_set<std::shared_ptr<Tile>> closedList;
-
-    auto startNode = std::make_shared<AStarNode>(startTile, nullptr, 0.0, heuristic(startTile, goalTile));
-    openList.push(startNode);
-    allNodes[startTile] = startNode;
-
-    while (!openList.empty())
-    {
-        auto current = openList.top();
-        openList.pop();
-        closedList.insert(current->getCorrespondingTile());
-
-        if (current->getCorrespondingTile() == goalTile)
-            return reversePath(current);
-
-        auto neighbors = getNeighborTiles(current->getCorrespondingTile());
-        auto a = current->getCorrespondingTile()->getGameBoardCoordinates();
-        for (const auto& neighbor : neighbors)
-        {
-            if (closedList.count(neighbor))
-                continue;
-
-            if (neighbor->getResidingSprite() != nullptr)
-                continue;
-
-            double tentativeG = current->getGValue() + 1.0;
-            double hCost = heuristic(neighbor, goalTile);
-            auto neighborNode = std::make_shared<AStarNode>(neighbor, current, tentativeG, hCost);
-
-            if (allNodes.find(neighbor) == allNodes.end() || tentativeG < allNodes[neighbor]->getGValue())
-            {
-                openList.push(neighborNode);
-                allNodes[neighbor] = neighborNode;
-            }
-        }
-    }
-    return {};
-}
-
-bool GameBoard::isSolved()
-{
-    for (const auto& column : m_tiles)
-    {
-        for (const auto& tile : column)
-        {
-            if (!tile->isGoalTile())
-                continue;
-
-            if (tile->getResidingSprite() == nullptr)
-                return false;
-        }
-    }
-    return true;
+    return m_occupancyHash ^ m_zobrist.getPlayerKey(getEnclosingTile(m_player).index);
 }
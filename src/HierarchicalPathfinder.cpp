@@ -0,0 +1,528 @@
+#include "HierarchicalPathfinder.h"
+#include <algorithm>
+
+void HierarchicalPathfinder::layout(const OccupancyGrid& grid)
+{
+    if (!m_clusters.empty() && m_columns == grid.getColumns() && m_rows == grid.getRows())
+        return;
+
+    m_columns = grid.getColumns();
+    m_rows = grid.getRows();
+    m_clustersX = (m_columns + m_clusterSize - 1) / m_clusterSize;
+    m_clustersY = (m_rows + m_clusterSize - 1) / m_clusterSize;
+
+    m_clusters.assign(static_cast<size_t>(m_clustersX) * m_clustersY, {});
+    m_dirtyClusters.clear();
+    for (int cy = 0; cy < m_clustersY; ++cy)
+    {
+        for (int cx = 0; cx < m_clustersX; ++cx)
+        {
+            Cluster& cluster = m_clusters[cy * m_clustersX + cx];
+            cluster.x0 = cx * m_clusterSize;
+            cluster.y0 = cy * m_clusterSize;
+            cluster.width = std::min(m_clusterSize, m_columns - cluster.x0);
+            cluster.height = std::min(m_clusterSize, m_rows - cluster.y0);
+            m_dirtyClusters.push_back(cy * m_clustersX + cx);
+        }
+    }
+
+    const int padded = (m_clusterSize + 2) * (m_clusterSize + 2);
+    m_localBlocked.assign(padded, 1);
+    m_localDistances.assign(padded, INF);
+    m_localParents.assign(padded, -1);
+    m_localQueue.resize(padded);
+    m_open.resize(grid.getSize());
+}
+
+void HierarchicalPathfinder::markDirty(int cluster)
+{
+    if (m_clusters[cluster].dirty)
+        return;
+    m_clusters[cluster].dirty = true;
+    m_dirtyClusters.push_back(cluster);
+}
+
+void HierarchicalPathfinder::invalidate(const OccupancyGrid& grid, TileIndex cell)
+{
+    // Before the first query everything is built from scratch anyway
+    if (m_clusters.empty() || m_columns != grid.getColumns() || m_rows != grid.getRows())
+        return;
+
+    const int x = grid.getX(cell);
+    const int y = grid.getY(cell);
+    const int cx = x / m_clusterSize;
+    const int cy = y / m_clusterSize;
+    markDirty(cy * m_clustersX + cx);
+
+    // A border cell also shapes the entrances of the cluster across that border
+    if (x % m_clusterSize == 0 && cx > 0)
+        markDirty(cy * m_clustersX + cx - 1);
+    if ((x + 1) % m_clusterSize == 0 && cx + 1 < m_clustersX)
+        markDirty(cy * m_clustersX + cx + 1);
+    if (y % m_clusterSize == 0 && cy > 0)
+        markDirty((cy - 1) * m_clustersX + cx);
+    if ((y + 1) % m_clusterSize == 0 && cy + 1 < m_clustersY)
+        markDirty((cy + 1) * m_clustersX + cx);
+}
+
+void HierarchicalPathfinder::invalidateAll()
+{
+    for (int cluster = 0; cluster < static_cast<int>(m_clusters.size()); ++cluster)
+        markDirty(cluster);
+}
+
+void HierarchicalPathfinder::refresh(const OccupancyGrid& grid)
+{
+    layout(grid);
+    if (m_dirtyClusters.empty())
+        return;
+
+    // Entrances of every stale cluster must exist before any distances are measured
+    for (int cluster : m_dirtyClusters)
+        buildEntrances(grid, cluster);
+    for (int cluster : m_dirtyClusters)
+    {
+        buildDistances(grid, cluster);
+        m_clusters[cluster].dirty = false;
+    }
+    m_dirtyClusters.clear();
+    m_componentsStale = true;
+}
+
+void HierarchicalPathfinder::prepare(const OccupancyGrid& grid)
+{
+    refresh(grid);
+    if (m_componentsStale)
+        buildComponents(grid);
+}
+
+void HierarchicalPathfinder::buildComponents(const OccupancyGrid& grid)
+{
+    // Number the entrances across all clusters, then join the ones a cluster or a border links
+    int count = 0;
+    for (Cluster& cluster : m_clusters)
+    {
+        for (Entrance& entrance : cluster.entrances)
+            entrance.component = count++;
+    }
+    m_componentParents.resize(count);
+    for (int i = 0; i < count; ++i)
+        m_componentParents[i] = i;
+
+    for (int index = 0; index < static_cast<int>(m_clusters.size()); ++index)
+    {
+        const Cluster& cluster = m_clusters[index];
+        const int size = static_cast<int>(cluster.entrances.size());
+        for (int i = 0; i < size; ++i)
+        {
+            // Reachability inside a cluster is symmetric and transitive, so linking each entrance
+            // to the next one it reaches chains its whole class together
+            const Entrance& entrance = cluster.entrances[i];
+            for (int j = i + 1; j < size; ++j)
+            {
+                if (cluster.distances[i * size + j] < INF)
+                {
+                    m_componentParents[findRoot(entrance.component)] = findRoot(cluster.entrances[j].component);
+                    break;
+                }
+            }
+            // Partners pair up across each border, so every link is joined from its lower cluster
+            for (int p = 0; p < entrance.partnerCount; ++p)
+            {
+                const int neighborIndex = getClusterOf(grid, entrance.partners[p]);
+                if (neighborIndex < index)
+                    continue;
+                const Cluster& neighbor = m_clusters[neighborIndex];
+                const int slot = findEntrance(neighbor, entrance.partners[p]);
+                if (slot >= 0)
+                    m_componentParents[findRoot(entrance.component)] = findRoot(neighbor.entrances[slot].component);
+            }
+        }
+    }
+
+    for (Cluster& cluster : m_clusters)
+    {
+        for (Entrance& entrance : cluster.entrances)
+            entrance.component = findRoot(entrance.component);
+    }
+    m_componentsStale = false;
+}
+
+int HierarchicalPathfinder::findRoot(int entrance)
+{
+    while (m_componentParents[entrance] != entrance)
+    {
+        m_componentParents[entrance] = m_componentParents[m_componentParents[entrance]];
+        entrance = m_componentParents[entrance];
+    }
+    return entrance;
+}
+
+bool HierarchicalPathfinder::canConnect(const Cluster& startCluster, const Cluster& goalCluster) const
+{
+    for (size_t i = 0; i < startCluster.entrances.size(); ++i)
+    {
+        if (m_startDistances[i] >= INF)
+            continue;
+        for (size_t j = 0; j < goalCluster.entrances.size(); ++j)
+        {
+            if (m_goalDistances[j] < INF && startCluster.entrances[i].component == goalCluster.entrances[j].component)
+                return true;
+        }
+    }
+    return false;
+}
+
+void HierarchicalPathfinder::buildEntrances(const OccupancyGrid& grid, int cluster)
+{
+    m_clusters[cluster].entrances.clear();
+
+    addBorderEntrances(grid, cluster, 0, -1);
+    addBorderEntrances(grid, cluster, -1, 0);
+    addBorderEntrances(grid, cluster, 1, 0);
+    addBorderEntrances(grid, cluster, 0, 1);
+}
+
+void HierarchicalPathfinder::addBorderEntrances(const OccupancyGrid& grid, int cluster, int dx, int dy)
+{
+    Cluster& c = m_clusters[cluster];
+
+    // Cell on this cluster's edge and the cell across the border, per position along the edge
+    const int edgeX = dx > 0 ? c.x0 + c.width - 1 : c.x0;
+    const int edgeY = dy > 0 ? c.y0 + c.height - 1 : c.y0;
+    if (!grid.contains(edgeX + dx, edgeY + dy))
+        return;
+
+    const int length = dx != 0 ? c.height : c.width;
+    auto cellAt = [&](int t) { return dx != 0 ? grid.toIndex(edgeX, c.y0 + t) : grid.toIndex(c.x0 + t, edgeY); };
+    const int across = dy * grid.getColumns() + dx;
+
+    auto addEntrance = [&](int t)
+    {
+        TileIndex cell = cellAt(t);
+        // A corner cell can already be an entrance on the cluster's other border
+        int slot = findEntrance(c, cell);
+        if (slot < 0)
+        {
+            c.entrances.push_back({ cell, { cell + across, -1 }, 1 });
+        }
+        else
+        {
+            Entrance& entrance = c.entrances[slot];
+            entrance.partners[entrance.partnerCount++] = cell + across;
+        }
+    };
+
+    // Both sides scan the same border with the same rule, so their entrances pair up
+    int runStart = -1;
+    for (int t = 0; t <= length; ++t)
+    {
+        bool open = t < length && !grid.isBlocked(cellAt(t)) && !grid.isBlocked(cellAt(t) + across);
+        if (open && runStart < 0)
+            runStart = t;
+        if (open || runStart < 0)
+            continue;
+
+        // Long openings get an entrance at each end, short ones a single entrance in the middle
+        const int runLength = t - runStart;
+        if (runLength > 6)
+        {
+            addEntrance(runStart);
+            addEntrance(t - 1);
+        }
+        else
+        {
+            addEntrance(runStart + runLength / 2);
+        }
+        runStart = -1;
+    }
+}
+
+void HierarchicalPathfinder::buildDistances(const OccupancyGrid& grid, int cluster)
+{
+    Cluster& c = m_clusters[cluster];
+    const int count = static_cast<int>(c.entrances.size());
+    c.distances.assign(static_cast<size_t>(count) * count, INF);
+    loadCluster(grid, c);
+    for (int i = 0; i < count; ++i)
+    {
+        searchCluster(grid, c.entrances[i].cell);
+        for (int j = 0; j < count; ++j)
+            c.distances[i * count + j] = getLocalDistance(grid, c.entrances[j].cell);
+    }
+}
+
+int HierarchicalPathfinder::getClusterOf(const OccupancyGrid& grid, TileIndex cell) const
+{
+    return (grid.getY(cell) / m_clusterSize) * m_clustersX + grid.getX(cell) / m_clusterSize;
+}
+
+int HierarchicalPathfinder::findEntrance(const Cluster& cluster, TileIndex cell)
+{
+    for (size_t i = 0; i < cluster.entrances.size(); ++i)
+    {
+        if (cluster.entrances[i].cell == cell)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+void HierarchicalPathfinder::loadCluster(const OccupancyGrid& grid, const Cluster& cluster)
+{
+    m_localX0 = cluster.x0;
+    m_localY0 = cluster.y0;
+    m_localWidth = cluster.width;
+    m_localHeight = cluster.height;
+
+    // The frame around the copy stays blocked, so the search never needs bounds checks
+    const int stride = m_localWidth + 2;
+    std::fill(m_localBlocked.begin(), m_localBlocked.end(), 1);
+    for (int y = 0; y < m_localHeight; ++y)
+    {
+        TileIndex row = grid.toIndex(m_localX0, m_localY0 + y);
+        for (int x = 0; x < m_localWidth; ++x)
+            m_localBlocked[(y + 1) * stride + x + 1] = grid.isBlocked(row + x) ? 1 : 0;
+    }
+}
+
+int HierarchicalPathfinder::toLocal(const OccupancyGrid& grid, TileIndex cell) const
+{
+    const int x = grid.getX(cell) - m_localX0;
+    const int y = grid.getY(cell) - m_localY0;
+    if (x < 0 || y < 0 || x >= m_localWidth || y >= m_localHeight)
+        return -1;
+    return (y + 1) * (m_localWidth + 2) + x + 1;
+}
+
+void HierarchicalPathfinder::searchCluster(const OccupancyGrid& grid, TileIndex source)
+{
+    const int stride = m_localWidth + 2;
+    std::fill(m_localDistances.begin(), m_localDistances.end(), INF);
+
+    int head = 0;
+    int tail = 0;
+    const int origin = toLocal(grid, source);
+    m_localDistances[origin] = 0;
+    m_localParents[origin] = -1;
+    m_localQueue[tail++] = origin;
+
+    const std::array<int, 4> offsets = { -stride, -1, 1, stride };
+    while (head < tail)
+    {
+        const int current = m_localQueue[head++];
+        for (int offset : offsets)
+        {
+            const int neighbor = current + offset;
+            if (m_localBlocked[neighbor] || m_localDistances[neighbor] != INF)
+                continue;
+
+            m_localDistances[neighbor] = m_localDistances[current] + 1;
+            m_localParents[neighbor] = current;
+            m_localQueue[tail++] = neighbor;
+        }
+    }
+}
+
+int HierarchicalPathfinder::getLocalDistance(const OccupancyGrid& grid, TileIndex cell) const
+{
+    const int local = toLocal(grid, cell);
+    return local < 0 ? INF : m_localDistances[local];
+}
+
+bool HierarchicalPathfinder::appendLocalPath(const OccupancyGrid& grid, TileIndex from, TileIndex to, std::vector<TileIndex>& path)
+{
+    loadCluster(grid, m_clusters[getClusterOf(grid, from)]);
+    searchCluster(grid, from);
+    const int target = toLocal(grid, to);
+    if (target < 0 || m_localDistances[target] >= INF)
+        return false;
+
+    // Walk back from the target, then flip the appended stretch into order
+    const int stride = m_localWidth + 2;
+    const int origin = toLocal(grid, from);
+    const size_t begin = path.size();
+    for (int local = target; local != origin; local = m_localParents[local])
+        path.push_back(grid.toIndex(m_localX0 + local % stride - 1, m_localY0 + local / stride - 1));
+    std::reverse(path.begin() + begin, path.end());
+    return true;
+}
+
+int HierarchicalPathfinder::addNode(TileIndex cell, int slot)
+{
+    m_nodes.push_back({ cell, INF, -1, slot, false });
+    return static_cast<int>(m_nodes.size()) - 1;
+}
+
+int HierarchicalPathfinder::getEntranceNode(int cluster, int slot)
+{
+    Entrance& entrance = m_clusters[cluster].entrances[slot];
+    if (entrance.generation != m_generation)
+    {
+        entrance.generation = m_generation;
+        entrance.node = addNode(entrance.cell, slot);
+    }
+    return entrance.node;
+}
+
+int HierarchicalPathfinder::getNode(const OccupancyGrid& grid, TileIndex cell)
+{
+    const int cluster = getClusterOf(grid, cell);
+    const int slot = findEntrance(m_clusters[cluster], cell);
+    if (slot >= 0)
+        return getEntranceNode(cluster, slot);
+
+    // The goal can be reached along several edges; the start is only ever the source
+    if (cell != m_goal)
+        return addNode(cell, -1);
+    if (m_goalNode < 0)
+        m_goalNode = addNode(cell, -1);
+    return m_goalNode;
+}
+
+void HierarchicalPathfinder::relax(int from, int to, int cost, int goalH)
+{
+    if (cost >= INF || m_nodes[to].closed)
+        return;
+
+    const int tentativeG = m_nodes[from].gScore + cost;
+    if (tentativeG >= m_nodes[to].gScore)
+        return;
+
+    m_nodes[to].gScore = tentativeG;
+    m_nodes[to].parent = from;
+    m_open.push(to, { tentativeG + goalH, goalH });
+}
+
+bool HierarchicalPathfinder::findPath(const OccupancyGrid& grid, TileIndex start, TileIndex goal, std::vector<TileIndex>& path)
+{
+    path.clear();
+    const int size = grid.getSize();
+    if (start < 0 || goal < 0 || start >= size || goal >= size || grid.isBlocked(start) || grid.isBlocked(goal))
+        return false;
+
+    if (start == goal)
+    {
+        path.push_back(start);
+        return true;
+    }
+
+    refresh(grid);
+    m_goal = goal;
+
+    const int startCluster = getClusterOf(grid, start);
+    const int goalCluster = getClusterOf(grid, goal);
+    const Cluster& first = m_clusters[startCluster];
+    const Cluster& last = m_clusters[goalCluster];
+
+    // Connect start and goal to the entrances of their own clusters
+    loadCluster(grid, first);
+    searchCluster(grid, start);
+    m_startDistances.resize(first.entrances.size());
+    for (size_t i = 0; i < first.entrances.size(); ++i)
+        m_startDistances[i] = getLocalDistance(grid, first.entrances[i].cell);
+    const int direct = startCluster == goalCluster ? getLocalDistance(grid, goal) : INF;
+
+    loadCluster(grid, last);
+    searchCluster(grid, goal);
+    m_goalDistances.resize(last.entrances.size());
+    for (size_t i = 0; i < last.entrances.size(); ++i)
+        m_goalDistances[i] = getLocalDistance(grid, last.entrances[i].cell);
+
+    // Without a shared component no abstract search can succeed, so unreachable goals fail here
+    // rather than after exhausting every entrance the start can reach. Stale components can only
+    // let a hopeless search run, so they are rebuilt just when they would turn the query away
+    if (direct >= INF && !canConnect(first, last))
+    {
+        if (!m_componentsStale)
+            return false;
+        buildComponents(grid);
+        if (!canConnect(first, last))
+            return false;
+    }
+
+    // Entrances are only compared against the stamp, so clearing them on wrap-around is enough
+    if (++m_generation == 0)
+    {
+        for (Cluster& cluster : m_clusters)
+        {
+            for (Entrance& entrance : cluster.entrances)
+                entrance.generation = 0;
+        }
+        m_generation = 1;
+    }
+    m_open.clear();
+    m_nodes.clear();
+    m_goalNode = -1;
+
+    const int startNode = getNode(grid, start);
+    m_nodes[startNode].gScore = 0;
+    m_open.push(startNode, { grid.getDistance(start, goal), grid.getDistance(start, goal) });
+
+    int goalNode = -1;
+    while (!m_open.empty())
+    {
+        const int current = m_open.pop();
+        m_nodes[current].closed = true;
+        const TileIndex at = m_nodes[current].cell;
+        if (at == goal)
+        {
+            goalNode = current;
+            break;
+        }
+
+        if (current == startNode)
+        {
+            for (size_t i = 0; i < first.entrances.size(); ++i)
+            {
+                TileIndex cell = first.entrances[i].cell;
+                relax(current, getEntranceNode(startCluster, static_cast<int>(i)), m_startDistances[i], grid.getDistance(cell, goal));
+            }
+            relax(current, getNode(grid, goal), direct, 0);
+        }
+
+        const int slot = m_nodes[current].slot;
+        if (slot < 0)
+            continue;
+
+        const int clusterIndex = getClusterOf(grid, at);
+        const Cluster& cluster = m_clusters[clusterIndex];
+        const int count = static_cast<int>(cluster.entrances.size());
+        for (int j = 0; j < count; ++j)
+        {
+            TileIndex cell = cluster.entrances[j].cell;
+            if (j != slot && cluster.distances[slot * count + j] < INF)
+                relax(current, getEntranceNode(clusterIndex, j), cluster.distances[slot * count + j], grid.getDistance(cell, goal));
+        }
+
+        const Entrance& entrance = cluster.entrances[slot];
+        for (int p = 0; p < entrance.partnerCount; ++p)
+            relax(current, getNode(grid, entrance.partners[p]), 1, grid.getDistance(entrance.partners[p], goal));
+
+        if (clusterIndex == goalCluster && m_goalDistances[slot] < INF)
+            relax(current, getNode(grid, goal), m_goalDistances[slot], 0);
+    }
+
+    if (goalNode < 0)
+        return false;
+
+    m_abstractPath.clear();
+    for (int node = goalNode; node >= 0; node = m_nodes[node].parent)
+        m_abstractPath.push_back(m_nodes[node].cell);
+    std::reverse(m_abstractPath.begin(), m_abstractPath.end());
+
+    // Refine every abstract hop back into tiles
+    path.push_back(start);
+    for (size_t i = 1; i < m_abstractPath.size(); ++i)
+    {
+        TileIndex from = m_abstractPath[i - 1];
+        TileIndex to = m_abstractPath[i];
+        if (getClusterOf(grid, from) != getClusterOf(grid, to))
+            path.push_back(to);
+        else if (!appendLocalPath(grid, from, to, path))
+        {
+            path.clear();
+            return false;
+        }
+    }
+    return true;
+}
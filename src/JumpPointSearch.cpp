@@ -0,0 +1,206 @@
+#include "JumpPointSearch.h"
+#include <algorithm>
+#include <cstdlib>
+
+void JumpPointSearch::beginQuery(int size)
+{
+    if (m_nodes.size() != size)
+    {
+        m_nodes.assign(size, { 0, -1, 0, 0, 0, 0 });
+        m_open.resize(size);
+        m_generation = 0;
+    }
+
+    m_open.clear();
+    m_expandedCount = 0;
+    if (++m_generation == 0)
+    {
+        m_nodes.clear();
+        m_generation = 1;
+    }
+}
+
+bool JumpPointSearch::isOpen(const OccupancyGrid& grid, int x, int y) const
+{
+    return grid.contains(x, y) && !grid.isBlocked(grid.toIndex(x, y));
+}
+
+int JumpPointSearch::jumpHorizontal(const OccupancyGrid& grid, int x, int y, int dx) const
+{
+    // A cell is a jump point when the row above or below opens up right after a wall,
+    // i.e. the only shortest way into that side goes through this cell
+    const BitGrid& bits = grid.getBlockedBits();
+    const int words = bits.getWordsPerRow();
+    const uint64_t* row = bits.getRow(y);
+    const uint64_t* above = y > 0 ? bits.getRow(y - 1) : nullptr;
+    const uint64_t* below = y + 1 < bits.getRows() ? bits.getRow(y + 1) : nullptr;
+    const uint64_t allBlocked = ~uint64_t{ 0 };
+    const int from = x + dx;
+    if (from < 0 || from >= grid.getColumns())
+        return -1;
+
+    auto wordOf = [&](const uint64_t* side, int word) { return side && word >= 0 && word < words ? side[word] : allBlocked; };
+
+    if (dx > 0)
+    {
+        uint64_t range = ~uint64_t{ 0 } << (from & 63);
+        for (int word = from >> 6; word < words; ++word)
+        {
+            const uint64_t a = wordOf(above, word);
+            const uint64_t b = wordOf(below, word);
+            const uint64_t carryA = word > 0 ? wordOf(above, word - 1) >> 63 : 0;
+            const uint64_t carryB = word > 0 ? wordOf(below, word - 1) >> 63 : 0;
+            uint64_t forced = (((a << 1) | carryA) & ~a) | (((b << 1) | carryB) & ~b);
+            if (y == m_goalY && (m_goalX >> 6) == word)
+                forced |= uint64_t{ 1 } << (m_goalX & 63);
+
+            uint64_t walls = (row[word] | ~bits.getColumnMask(word)) & range;
+            forced &= range;
+            if (forced | walls)
+            {
+                const int firstForced = forced ? BitGrid::countTrailingZeros(forced) : 64;
+                const int firstWall = walls ? BitGrid::countTrailingZeros(walls) : 64;
+                return firstForced < firstWall ? word * 64 + firstForced : -1;
+            }
+            range = ~uint64_t{ 0 };
+        }
+        return -1;
+    }
+
+    uint64_t range = BitGrid::lowMask(from & 63);
+    for (int word = from >> 6; word >= 0; --word)
+    {
+        const uint64_t a = wordOf(above, word);
+        const uint64_t b = wordOf(below, word);
+        const uint64_t carryA = word + 1 < words ? (wordOf(above, word + 1) & 1) << 63 : 0;
+        const uint64_t carryB = word + 1 < words ? (wordOf(below, word + 1) & 1) << 63 : 0;
+        uint64_t forced = (((a >> 1) | carryA) & ~a) | (((b >> 1) | carryB) & ~b);
+        if (y == m_goalY && (m_goalX >> 6) == word)
+            forced |= uint64_t{ 1 } << (m_goalX & 63);
+
+        uint64_t walls = row[word] & range;
+        forced &= range & bits.getColumnMask(word);
+        if (forced | walls)
+        {
+            const int lastForced = forced ? 63 - BitGrid::countLeadingZeros(forced) : -1;
+            const int lastWall = walls ? 63 - BitGrid::countLeadingZeros(walls) : -1;
+            return lastForced > lastWall ? word * 64 + lastForced : -1;
+        }
+        range = ~uint64_t{ 0 };
+    }
+    return -1;
+}
+
+int JumpPointSearch::jumpVertical(const OccupancyGrid& grid, int x, int y, int dy) const
+{
+    for (int currentY = y + dy; isOpen(grid, x, currentY); currentY += dy)
+    {
+        // Vertical runs stop wherever one of their horizontal branches finds a jump point
+        if ((x == m_goalX && currentY == m_goalY) ||
+            jumpHorizontal(grid, x, currentY, 1) >= 0 ||
+            jumpHorizontal(grid, x, currentY, -1) >= 0)
+            return currentY;
+    }
+    return -1;
+}
+
+void JumpPointSearch::push(const OccupancyGrid& grid, TileIndex from, TileIndex to, int dx, int dy)
+{
+    Node& node = m_nodes.edit(to);
+    if (node.closedGeneration == m_generation)
+        return;
+
+    const int tentativeG = m_nodes.get(from).gScore + grid.getDistance(from, to);
+    if (node.seenGeneration == m_generation && tentativeG >= node.gScore)
+        return;
+
+    node.gScore = tentativeG;
+    node.parent = from;
+    node.directionX = static_cast<int8_t>(dx);
+    node.directionY = static_cast<int8_t>(dy);
+    node.seenGeneration = m_generation;
+    const int h = grid.getDistance(to, m_goal);
+    m_open.push(to, { tentativeG + h, h });
+}
+
+bool JumpPointSearch::findPath(const OccupancyGrid& grid, TileIndex start, TileIndex goal, std::vector<TileIndex>& path)
+{
+    path.clear();
+    const int size = grid.getSize();
+    if (start < 0 || goal < 0 || start >= size || goal >= size || grid.isBlocked(goal))
+        return false;
+
+    beginQuery(size);
+    m_goal = goal;
+    m_goalX = grid.getX(goal);
+    m_goalY = grid.getY(goal);
+
+    m_nodes.set(start, { 0, -1, m_generation, 0, 0, 0 });
+    m_open.push(start, { grid.getDistance(start, goal), grid.getDistance(start, goal) });
+
+    while (!m_open.empty())
+    {
+        TileIndex current = m_open.pop();
+        m_nodes.edit(current).closedGeneration = m_generation;
+        ++m_expandedCount;
+
+        if (current == goal)
+        {
+            // Expand the straight segments between jump points back into tiles
+            for (TileIndex cell = goal; m_nodes.get(cell).parent >= 0; cell = m_nodes.get(cell).parent)
+            {
+                const Node& node = m_nodes.get(cell);
+                const int step = node.directionY * grid.getColumns() + node.directionX;
+                for (TileIndex between = cell; between != node.parent; between -= step)
+                    path.push_back(between);
+            }
+            path.push_back(start);
+            std::reverse(path.begin(), path.end());
+            return true;
+        }
+
+        const int x = grid.getX(current);
+        const int y = grid.getY(current);
+        const int dx = m_nodes.get(current).directionX;
+        const int dy = m_nodes.get(current).directionY;
+
+        auto tryHorizontal = [&](int direction)
+        {
+            int jumpX = jumpHorizontal(grid, x, y, direction);
+            if (jumpX >= 0)
+                push(grid, current, grid.toIndex(jumpX, y), direction, 0);
+        };
+        auto tryVertical = [&](int direction)
+        {
+            int jumpY = jumpVertical(grid, x, y, direction);
+            if (jumpY >= 0)
+                push(grid, current, grid.toIndex(x, jumpY), 0, direction);
+        };
+
+        if (dx == 0 && dy == 0)
+        {
+            tryHorizontal(1);
+            tryHorizontal(-1);
+            tryVertical(1);
+            tryVertical(-1);
+        }
+        else if (dy != 0)
+        {
+            tryVertical(dy);
+            tryHorizontal(1);
+            tryHorizontal(-1);
+        }
+        else
+        {
+            tryHorizontal(dx);
+
+            // Turn only into the sides that are shadowed by a wall behind this cell
+            for (int side : { -1, 1 })
+            {
+                if (!isOpen(grid, x - dx, y + side) && isOpen(grid, x, y + side))
+                    tryVertical(side);
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,250 @@
+#include "LevelData.h"
+#include <charconv>
+#include <fstream>
+#include <stdexcept>
+#include "LevelText.h"
+#include "MappedFile.h"
+
+namespace
+{
+    /**
+     * @brief Walks level text once, line by line, keeping the position for error messages
+     */
+    class LevelParser
+    {
+    public:
+        LevelParser(std::string_view text, const std::string& name)
+            : m_begin(text.data()),
+              m_line(text.data()),
+              m_end(text.data() + text.size()),
+              m_name(name) {}
+
+        [[noreturn]] void fail(const char* at, const std::string& message) const
+        {
+            throw std::runtime_error(
+                m_name + ":" + std::to_string(m_lineNumber) + ":" +
+                std::to_string(at - m_line + 1) + ": " + message);
+        }
+
+        /**
+         * @brief Fails at the end of the text, wherever parsing had got to
+         */
+        [[noreturn]] void failAtEnd(const std::string& message)
+        {
+            m_line = m_begin;
+            m_lineNumber = 1;
+            for (const char* lineEnd = LevelText::findLineEnd(m_line, m_end); lineEnd < m_end;
+                 lineEnd = LevelText::findLineEnd(m_line, m_end))
+                advance(lineEnd);
+            fail(m_end, message);
+        }
+
+        const char* getLine() const { return m_line; }
+        const char* getEnd() const { return m_end; }
+
+        /**
+         * @brief Moves past the newline that ends the current line
+         */
+        void advance(const char* lineEnd)
+        {
+            if (lineEnd < m_end)
+            {
+                m_line = lineEnd + 1;
+                ++m_lineNumber;
+            }
+            else
+            {
+                m_line = m_end;
+            }
+        }
+
+        /**
+         * @brief Skips lines that contain only whitespace; false at the end of the text
+         */
+        bool skipBlankLines()
+        {
+            while (m_line < m_end)
+            {
+                const char* c = m_line;
+                while (c < m_end && LevelText::isBlank(*c))
+                    ++c;
+                if (c < m_end && *c != '\n')
+                    return true;
+                advance(c);
+            }
+            return false;
+        }
+
+        int readDimension(const char* begin, const char* end)
+        {
+            const std::string_view field = LevelText::trim(begin, end);
+            int value = 0;
+            const auto [last, error] = std::from_chars(field.data(), field.data() + field.size(), value);
+            if (field.empty() || error != std::errc() || last != field.data() + field.size() || value <= 0)
+                fail(field.empty() ? begin : field.data(), "Invalid board dimensions");
+            return value;
+        }
+
+    private:
+        const char* m_begin;
+        const char* m_line;
+        const char* m_end;
+        const std::string& m_name;
+        int m_lineNumber{ 1 };
+    };
+}
+
+LevelData::LevelData(int rows, int columns)
+    : m_rows(rows),
+      m_columns(columns),
+      m_tileKeys(static_cast<size_t>(rows) * columns, 0),
+      m_immovableKeys(static_cast<size_t>(rows) * columns, getEmptyKeyId()),
+      m_movableKeys(static_cast<size_t>(rows) * columns, getEmptyKeyId()),
+      m_goals(static_cast<size_t>(rows) * columns, 0)
+{
+    internKey("");
+    internKey(getEmptyKey());
+}
+
+LevelData LevelData::load(const std::string& path)
+{
+    MappedFile file(path);
+    return parse(file.getView(), path);
+}
+
+LevelData LevelData::parse(std::string_view text, const std::string& name)
+{
+    LevelParser parser(text, name);
+    const char* end = parser.getEnd();
+
+    // "rows,columns" on the first line
+    const char* header = parser.getLine();
+    const char* headerEnd = LevelText::findLineEnd(header, end);
+    const char* separator = LevelText::findDelimiter(header, headerEnd);
+    const int rows = parser.readDimension(header, separator);
+    const int columns = parser.readDimension(separator < headerEnd ? separator + 1 : headerEnd, headerEnd);
+
+    // Every cell but the last is followed by a delimiter, so this many cells can't fit in fewer bytes;
+    // checked before the matrices are allocated from the header
+    const uint64_t cells = static_cast<uint64_t>(rows) * columns;
+    if (cells * 3 > text.size() + 1)
+        parser.failAtEnd("Unexpected end of file in matrix data");
+    parser.advance(headerEnd);
+
+    LevelData level(rows, columns);
+
+    // Key ids by their text in the buffer; only keys not seen before reach the level's own table
+    std::unordered_map<std::string_view, uint16_t> ids;
+    std::string_view lastKey;
+    uint16_t lastId = 0;
+    auto intern = [&](std::string_view key)
+    {
+        if (key == lastKey && lastKey.data() != nullptr)
+            return lastId;
+        auto it = ids.find(key);
+        const uint16_t id = it != ids.end() ? it->second : ids.emplace(key, level.internKey(key)).first->second;
+        lastKey = key;
+        lastId = id;
+        return id;
+    };
+
+    LevelText::DelimiterScanner scanner(parser.getLine(), end);
+    std::vector<uint16_t>* matrices[] = { &level.m_tileKeys, &level.m_immovableKeys, &level.m_movableKeys };
+    for (std::vector<uint16_t>* matrix : matrices)
+    {
+        const bool tiles = matrix == &level.m_tileKeys;
+        uint16_t* keys = matrix->data();
+        for (int y = 0; y < rows; ++y)
+        {
+            if (!parser.skipBlankLines())
+                parser.failAtEnd("Unexpected end of file in matrix data");
+
+            // The same scan finds both the commas and the newline that ends the row
+            const char* cell = parser.getLine();
+            const char* extra = nullptr;
+            int x = 0;
+            while (true)
+            {
+                const char* cellEnd = scanner.next(cell);
+                if (x < columns)
+                {
+                    std::string_view key = LevelText::trim(cell, cellEnd);
+                    if (tiles && !key.empty() && key.front() == getGoalMarker())
+                    {
+                        key.remove_prefix(1);
+                        level.m_goals[static_cast<size_t>(y) * columns + x] = 1;
+                    }
+                    keys[static_cast<size_t>(y) * columns + x] = intern(key);
+                }
+                else if (x == columns)
+                {
+                    extra = cell;
+                }
+                ++x;
+
+                if (cellEnd == end || *cellEnd == '\n')
+                {
+                    if (x != columns)
+                    {
+                        parser.fail(extra ? extra : cellEnd,
+                            "Row size mismatch in matrix data; row size: " + std::to_string(x) +
+                            ", expected: " + std::to_string(columns));
+                    }
+                    parser.advance(cellEnd);
+                    break;
+                }
+                cell = cellEnd + 1;
+            }
+        }
+    }
+    return level;
+}
+
+void LevelData::save(const std::string& path) const
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+        throw std::runtime_error("Could not open file: " + path);
+    write(file);
+}
+
+void LevelData::write(std::ostream& stream) const
+{
+    stream << m_rows << ',' << m_columns << '\n';
+
+    auto writeMatrix = [&](const std::vector<uint16_t>& keys, bool markGoals)
+    {
+        for (int y = 0; y < m_rows; ++y)
+        {
+            for (int x = 0; x < m_columns; ++x)
+            {
+                if (x > 0)
+                    stream << ',';
+                if (markGoals && isGoal(x, y))
+                    stream << getGoalMarker();
+                stream << m_keys[keys[toIndex(x, y)]];
+            }
+            stream << '\n';
+        }
+    };
+
+    writeMatrix(m_tileKeys, true);
+    stream << '\n';
+    writeMatrix(m_immovableKeys, false);
+    stream << '\n';
+    writeMatrix(m_movableKeys, false);
+}
+
+uint16_t LevelData::internKey(std::string_view key)
+{
+    auto it = m_keyIds.find(std::string(key));
+    if (it != m_keyIds.end())
+        return it->second;
+    if (m_keys.size() > UINT16_MAX)
+        throw std::runtime_error("LevelData: Too many distinct keys");
+
+    const uint16_t id = static_cast<uint16_t>(m_keys.size());
+    m_keys.emplace_back(key);
+    m_keyIds.emplace(m_keys.back(), id);
+    return id;
+}
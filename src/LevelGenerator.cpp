@@ -0,0 +1,246 @@
+#include "LevelGenerator.h"
+#include <algorithm>
+#include <random>
+#include <unordered_set>
+#include "PuzzleSolver.h"
+#include "ThreadPool.h"
+#include "ZobristTable.h"
+
+namespace
+{
+    constexpr int DIRECTIONS[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+}
+
+LevelGenerator::LevelGenerator(const Settings& settings) : m_settings(settings)
+{
+    if (!m_settings.terrainTiles.empty())
+        m_terrain = std::make_shared<const TerrainGenerator>(m_settings.terrainTiles);
+}
+
+LevelGenerator::Candidate LevelGenerator::generate(uint64_t seed) const
+{
+    const int columns = m_settings.columns;
+    const int rows = m_settings.rows;
+    const int cells = columns * rows;
+    std::mt19937_64 rng(seed);
+    Candidate candidate;
+    candidate.seed = seed;
+
+    // Walls first, leaving the player's starting tile free
+    BoardMasks masks(columns, rows);
+    std::bernoulli_distribution wall(m_settings.wallDensity);
+    std::vector<TileIndex> free;
+    for (TileIndex cell = 0; cell < cells; ++cell)
+    {
+        if (cell != 0 && wall(rng))
+        {
+            masks.setWall(cell % columns, cell / columns, true);
+            masks.setOccupied(cell % columns, cell / columns, true);
+        }
+        else if (cell != 0)
+        {
+            free.push_back(cell);
+        }
+    }
+
+    if (static_cast<int>(free.size()) < m_settings.objectCount + 1)
+        return candidate;
+
+    // The solved board: one object on every goal
+    std::shuffle(free.begin(), free.end(), rng);
+    std::vector<TileIndex> objects(free.begin(), free.begin() + m_settings.objectCount);
+    for (TileIndex cell : objects)
+    {
+        masks.setGoal(cell % columns, cell / columns, true);
+        masks.setOccupied(cell % columns, cell / columns, true);
+    }
+
+    const TileIndex player = free[m_settings.objectCount];
+    BitGrid reached;
+    masks.fillReachable(player % columns, player / columns, reached);
+
+    ZobristTable zobrist(cells);
+    std::unordered_set<uint64_t> visited;
+    auto getHash = [&]()
+    {
+        uint64_t hash = 0;
+        for (TileIndex cell : objects)
+            hash ^= zobrist.getOccupiedKey(cell);
+        for (TileIndex cell = 0; cell < cells; ++cell)
+        {
+            if (reached.test(cell % columns, cell / columns))
+                return hash ^ zobrist.getPlayerKey(cell);
+        }
+        return hash;
+    };
+    visited.insert(getHash());
+
+    std::vector<TileIndex> best;
+    double branchingSum = 0.0;
+    double bestBranching = 0.0;
+    std::vector<Pull> pulls;
+    BitGrid nextReached;
+    for (int step = 1; step <= m_settings.reverseMoves; ++step)
+    {
+        collectPulls(masks, objects, reached, pulls);
+        std::shuffle(pulls.begin(), pulls.end(), rng);
+
+        // Take the first pull that leads somewhere new
+        bool moved = false;
+        for (const Pull& pull : pulls)
+        {
+            const TileIndex from = objects[pull.object];
+            masks.setOccupied(from % columns, from / columns, false);
+            masks.setOccupied(pull.to % columns, pull.to / columns, true);
+            objects[pull.object] = pull.to;
+            std::swap(reached, nextReached);
+            masks.fillReachable(pull.pusher % columns, pull.pusher / columns, reached);
+
+            if (visited.insert(getHash()).second)
+            {
+                moved = true;
+                break;
+            }
+
+            std::swap(reached, nextReached);
+            objects[pull.object] = from;
+            masks.setOccupied(pull.to % columns, pull.to / columns, false);
+            masks.setOccupied(from % columns, from / columns, true);
+        }
+
+        if (!moved)
+            break;
+
+        // Only states where the player's starting tile can reach the pusher make a level
+        branchingSum += countPushes(masks, objects, reached);
+        if (reached.test(0, 0) && !masks.isSolved())
+        {
+            best = objects;
+            candidate.depth = step;
+            bestBranching = branchingSum / step;
+        }
+    }
+
+    if (candidate.depth == 0)
+        return candidate;
+
+    LevelData level(rows, columns);
+    for (int y = 0; y < rows; ++y)
+    {
+        for (int x = 0; x < columns; ++x)
+        {
+            level.setTileKey(x, y, m_settings.tileKey);
+            level.setGoal(x, y, masks.isGoal(x, y));
+            if (masks.isWall(x, y))
+                level.setImmovableKey(x, y, m_settings.wallKey);
+        }
+    }
+    for (TileIndex cell : best)
+        level.setMovableKey(cell % columns, cell / columns, m_settings.objectKey);
+    if (m_terrain)
+        m_terrain->fill(level, seed);
+
+    candidate.solutionLength = candidate.depth;
+    if (m_settings.verify)
+    {
+        PuzzleSolver solver(level);
+        solver.setThreadCount(1);
+        solver.setTableCapacity(size_t{ 1 } << 18);
+        solver.setMaxDepth(candidate.depth);
+        PuzzleSolver::Result result = solver.solve();
+        if (result.solved)
+            candidate.solutionLength = result.length;
+    }
+
+    // Roughly how many pushes a player could try along an optimal route
+    candidate.branching = bestBranching;
+    candidate.score = candidate.solutionLength * bestBranching;
+    candidate.level = std::move(level);
+    return candidate;
+}
+
+std::vector<LevelGenerator::Candidate> LevelGenerator::generateMany(int count, uint64_t firstSeed, int threadCount) const
+{
+    std::vector<Candidate> candidates(count);
+    {
+        ThreadPool pool(threadCount);
+        for (int i = 0; i < count; ++i)
+            pool.submit([this, &candidates, i, firstSeed] { candidates[i] = generate(firstSeed + i); });
+        pool.wait();
+    }
+
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                                    [](const Candidate& candidate) { return candidate.depth == 0; }),
+                     candidates.end());
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+    return candidates;
+}
+
+void LevelGenerator::collectPulls(const BoardMasks& masks, const std::vector<TileIndex>& objects,
+                                  const BitGrid& reached, std::vector<Pull>& pulls) const
+{
+    const int columns = masks.getColumns();
+    const int rows = masks.getRows();
+    auto isFree = [&](int x, int y) { return x >= 0 && y >= 0 && x < columns && y < rows && !masks.isOccupied(x, y); };
+
+    pulls.clear();
+    for (int i = 0; i < static_cast<int>(objects.size()); ++i)
+    {
+        const int stopX = objects[i] % columns;
+        const int stopY = objects[i] / columns;
+        for (const auto& direction : DIRECTIONS)
+        {
+            const int dirX = direction[0];
+            const int dirY = direction[1];
+
+            // A forward slide only ends here if the next cell is blocked
+            if (isFree(stopX + dirX, stopY + dirY))
+                continue;
+
+            for (int x = stopX - dirX, y = stopY - dirY; isFree(x, y); x -= dirX, y -= dirY)
+            {
+                // Same pusher cells as pushObject, which must be reachable after the push
+                const int pusherY = y - dirY;
+                const int firstX = dirX != 0 ? x - dirX : x - 1;
+                const int lastX = dirX != 0 ? x - dirX : x + 1;
+                for (int pusherX = firstX; pusherX <= lastX; ++pusherX)
+                {
+                    if (isFree(pusherX, pusherY) && reached.test(pusherX, pusherY))
+                        pulls.push_back({ i, y * columns + x, pusherY * columns + pusherX });
+                }
+            }
+        }
+    }
+}
+
+int LevelGenerator::countPushes(const BoardMasks& masks, const std::vector<TileIndex>& objects, const BitGrid& reached) const
+{
+    const int columns = masks.getColumns();
+    const int rows = masks.getRows();
+    int count = 0;
+    for (TileIndex cell : objects)
+    {
+        const int x = cell % columns;
+        const int y = cell / columns;
+        for (const auto& direction : DIRECTIONS)
+        {
+            if (masks.getSlideDistance(x, y, direction[0], direction[1]) == 0)
+                continue;
+
+            const int pusherY = y - direction[1];
+            const int firstX = direction[0] != 0 ? x - direction[0] : x - 1;
+            const int lastX = direction[0] != 0 ? x - direction[0] : x + 1;
+            for (int pusherX = firstX; pusherX <= lastX; ++pusherX)
+            {
+                if (pusherX >= 0 && pusherY >= 0 && pusherX < columns && pusherY < rows &&
+                    !masks.isOccupied(pusherX, pusherY) && reached.test(pusherX, pusherY))
+                {
+                    ++count;
+                    break;
+                }
+            }
+        }
+    }
+    return count;
+}
@@ -0,0 +1,347 @@
+#include "PuzzleSolver.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+PuzzleSolver::PuzzleSolver(const LevelData& level, TileIndex playerStart)
+    : m_masks(level.getColumns(), level.getRows()),
+      m_zobrist(level.getColumns() * level.getRows())
+{
+    for (int y = 0; y < level.getRows(); ++y)
+    {
+        for (int x = 0; x < level.getColumns(); ++x)
+        {
+            m_masks.setGoal(x, y, level.isGoal(x, y));
+            if (level.hasImmovable(x, y))
+            {
+                m_masks.setWall(x, y, true);
+                m_masks.setOccupied(x, y, true);
+            }
+            else if (level.hasMovable(x, y))
+            {
+                m_start.push_back(y * level.getColumns() + x);
+            }
+        }
+    }
+
+    m_objectCount = static_cast<int>(m_start.size());
+    m_stride = m_objectCount + 1;
+    m_start.push_back(playerStart);
+    m_deadlocks.build(m_masks, m_objectCount);
+}
+
+PuzzleSolver::Result PuzzleSolver::solve()
+{
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point startTime = Clock::now();
+    Result result;
+
+    int threadCount = m_threadCount;
+    if (threadCount <= 0)
+        threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+    size_t capacity = 1;
+    while (capacity < m_tableCapacity)
+        capacity <<= 1;
+    m_table.reset(new std::atomic<uint64_t>[capacity]);
+    for (size_t i = 0; i < capacity; ++i)
+        m_table[i].store(0, std::memory_order_relaxed);
+    m_tableMask = capacity - 1;
+    m_tableCount = 0;
+    m_tableFull = false;
+    m_solved = false;
+
+    m_workers.clear();
+    m_workers.resize(threadCount);
+    for (Worker& worker : m_workers)
+        worker.masks = m_masks;
+    m_ranges.reset(new WorkRange[threadCount]);
+
+    // Name the starting region and check for a level that is already solved
+    Worker& first = m_workers.front();
+    std::vector<TileIndex> layer(m_start);
+    const int columns = m_masks.getColumns();
+    for (int i = 0; i < m_objectCount; ++i)
+        first.masks.setOccupied(layer[i] % columns, layer[i] / columns, true);
+    layer[m_objectCount] = getRegion(first.masks, m_start[m_objectCount], first.reached);
+    const bool solvedAtStart = first.masks.isSolved();
+    for (int i = 0; i < m_objectCount; ++i)
+        first.masks.setOccupied(layer[i] % columns, layer[i] / columns, false);
+    insert(getHash(layer.data()));
+
+    const size_t tableBytes = capacity * sizeof(std::atomic<uint64_t>);
+    result.peakMemory = tableBytes + layer.capacity() * sizeof(TileIndex);
+
+    if (solvedAtStart)
+    {
+        result.solved = true;
+        result.length = 0;
+    }
+
+    for (int depth = 0; !result.solved && depth < m_maxDepth && !layer.empty(); ++depth)
+    {
+        // Deal out even ranges; idle workers steal from busy ones after that
+        const size_t count = layer.size() / m_stride;
+        for (int i = 0; i < threadCount; ++i)
+        {
+            const uint32_t begin = static_cast<uint32_t>(count * i / threadCount);
+            const uint32_t end = static_cast<uint32_t>(count * (i + 1) / threadCount);
+            m_ranges[i].range.store(packRange(begin, end), std::memory_order_relaxed);
+        }
+
+        std::vector<std::thread> threads;
+        threads.reserve(threadCount - 1);
+        for (int i = 1; i < threadCount; ++i)
+            threads.emplace_back(&PuzzleSolver::runWorker, this, i, std::cref(layer));
+        runWorker(0, layer);
+        for (std::thread& thread : threads)
+            thread.join();
+
+        size_t nextSize = 0;
+        size_t memory = tableBytes + layer.capacity() * sizeof(TileIndex);
+        for (const Worker& worker : m_workers)
+        {
+            nextSize += worker.next.size();
+            memory += worker.next.capacity() * sizeof(TileIndex);
+        }
+        result.peakMemory = std::max(result.peakMemory, memory);
+
+        if (m_solved)
+        {
+            result.solved = true;
+            result.length = depth + 1;
+        }
+
+        if (m_tableFull)
+        {
+            result.tableFull = true;
+            break;
+        }
+
+        layer.clear();
+        layer.reserve(nextSize);
+        for (Worker& worker : m_workers)
+        {
+            layer.insert(layer.end(), worker.next.begin(), worker.next.end());
+            worker.next.clear();
+        }
+    }
+
+    for (const Worker& worker : m_workers)
+        result.nodes += worker.nodes;
+    result.seconds = std::chrono::duration<double>(Clock::now() - startTime).count();
+    result.nodesPerSecond = result.seconds > 0.0 ? result.nodes / result.seconds : 0.0;
+    return result;
+}
+
+void PuzzleSolver::runWorker(int id, const std::vector<TileIndex>& layer)
+{
+    Worker& worker = m_workers[id];
+    size_t index;
+    while (!m_solved.load(std::memory_order_relaxed) && !m_tableFull.load(std::memory_order_relaxed) &&
+           takeWork(id, index))
+    {
+        expand(worker, &layer[index * m_stride]);
+        ++worker.nodes;
+    }
+}
+
+bool PuzzleSolver::takeWork(int id, size_t& index)
+{
+    std::atomic<uint64_t>& own = m_ranges[id].range;
+    while (true)
+    {
+        uint64_t range = own.load(std::memory_order_acquire);
+        uint32_t begin = static_cast<uint32_t>(range >> 32);
+        uint32_t end = static_cast<uint32_t>(range);
+        if (begin < end)
+        {
+            if (own.compare_exchange_weak(range, packRange(begin + 1, end), std::memory_order_acq_rel))
+            {
+                index = begin;
+                return true;
+            }
+            continue;
+        }
+
+        // Out of work: take the upper half of someone else's range
+        bool stolen = false;
+        const int threadCount = static_cast<int>(m_workers.size());
+        for (int offset = 1; offset < threadCount && !stolen; ++offset)
+        {
+            std::atomic<uint64_t>& victim = m_ranges[(id + offset) % threadCount].range;
+            uint64_t victimRange = victim.load(std::memory_order_acquire);
+            while (true)
+            {
+                begin = static_cast<uint32_t>(victimRange >> 32);
+                end = static_cast<uint32_t>(victimRange);
+                if (begin >= end)
+                    break;
+
+                const uint32_t middle = begin + (end - begin) / 2;
+                if (victim.compare_exchange_weak(victimRange, packRange(begin, middle), std::memory_order_acq_rel))
+                {
+                    own.store(packRange(middle, end), std::memory_order_release);
+                    stolen = true;
+                    break;
+                }
+            }
+        }
+
+        // Nothing is added to a depth while it runs, so empty ranges everywhere mean it is done
+        if (!stolen)
+            return false;
+    }
+}
+
+void PuzzleSolver::expand(Worker& worker, const TileIndex* state)
+{
+    const int columns = m_masks.getColumns();
+    const int rows = m_masks.getRows();
+    BoardMasks& masks = worker.masks;
+    for (int i = 0; i < m_objectCount; ++i)
+        masks.setOccupied(state[i] % columns, state[i] / columns, true);
+
+    const TileIndex region = state[m_objectCount];
+    masks.fillReachable(region % columns, region / columns, worker.reached);
+    worker.state.assign(state, state + m_stride);
+
+    static constexpr int directions[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+    for (int moved = 0; moved < m_objectCount; ++moved)
+    {
+        const int x = state[moved] % columns;
+        const int y = state[moved] / columns;
+        for (const auto& direction : directions)
+        {
+            const int dirX = direction[0];
+            const int dirY = direction[1];
+            const int distance = masks.getSlideDistance(x, y, dirX, dirY);
+            if (distance == 0)
+                continue;
+
+            const int targetX = x + dirX * distance;
+            const int targetY = y + dirY * distance;
+            const TileIndex target = targetY * columns + targetX;
+
+            // pushObject takes the dominant axis of the offset, so diagonal neighbors push vertically
+            const int playerY = y - dirY;
+            const int firstX = dirX != 0 ? x - dirX : x - 1;
+            const int lastX = dirX != 0 ? x - dirX : x + 1;
+            int pushers[3];
+            int pusherCount = 0;
+            for (int playerX = firstX; playerX <= lastX; ++playerX)
+            {
+                if (playerX < 0 || playerY < 0 || playerX >= columns || playerY >= rows)
+                    continue;
+                if (!masks.isOccupied(playerX, playerY) && worker.reached.test(playerX, playerY))
+                    pushers[pusherCount++] = playerY * columns + playerX;
+            }
+            if (pusherCount == 0)
+                continue;
+
+            masks.setOccupied(x, y, false);
+            masks.setOccupied(targetX, targetY, true);
+            if (!m_deadlocks.isDeadlocked(masks, worker.deadlockScratch))
+            {
+                if (masks.isSolved())
+                    m_solved.store(true, std::memory_order_relaxed);
+
+                TileIndex previousRegion = -1;
+                for (int i = 0; i < pusherCount; ++i)
+                {
+                    const TileIndex player = getRegion(masks, pushers[i], worker.childReached);
+                    if (player == previousRegion)
+                        continue;
+                    previousRegion = player;
+                    addChild(worker, moved, target, player);
+                }
+            }
+            masks.setOccupied(targetX, targetY, false);
+            masks.setOccupied(x, y, true);
+        }
+    }
+
+    for (int i = 0; i < m_objectCount; ++i)
+        masks.setOccupied(state[i] % columns, state[i] / columns, false);
+}
+
+void PuzzleSolver::addChild(Worker& worker, int moved, TileIndex target, TileIndex player)
+{
+    // Keep object cells sorted so equal states have equal encodings
+    State& child = worker.child;
+    child.assign(worker.state.begin(), worker.state.end());
+    int i = moved;
+    while (i > 0 && child[i - 1] > target)
+    {
+        child[i] = child[i - 1];
+        --i;
+    }
+    while (i < m_objectCount - 1 && child[i + 1] < target)
+    {
+        child[i] = child[i + 1];
+        ++i;
+    }
+    child[i] = target;
+    child[m_objectCount] = player;
+
+    if (insert(getHash(child.data())))
+        worker.next.insert(worker.next.end(), child.begin(), child.end());
+}
+
+TileIndex PuzzleSolver::getRegion(const BoardMasks& masks, TileIndex player, BitGrid& reached) const
+{
+    const int columns = masks.getColumns();
+    masks.fillReachable(player % columns, player / columns, reached);
+
+    const int wordsPerRow = reached.getWordsPerRow();
+    for (int y = 0; y < reached.getRows(); ++y)
+    {
+        const uint64_t* row = reached.getRow(y);
+        for (int word = 0; word < wordsPerRow; ++word)
+        {
+            if (row[word])
+                return y * columns + word * 64 + BitGrid::countTrailingZeros(row[word]);
+        }
+    }
+    return player;
+}
+
+uint64_t PuzzleSolver::getHash(const TileIndex* state) const
+{
+    uint64_t hash = m_zobrist.getPlayerKey(state[m_objectCount]);
+    for (int i = 0; i < m_objectCount; ++i)
+        hash ^= m_zobrist.getOccupiedKey(state[i]);
+    return hash;
+}
+
+bool PuzzleSolver::insert(uint64_t hash)
+{
+    // Zero marks an empty slot; two states sharing a 64-bit hash are treated as one
+    if (hash == 0)
+        hash = 1;
+
+    size_t slot = static_cast<size_t>(hash) & m_tableMask;
+    for (size_t probe = 0; probe <= m_tableMask; ++probe)
+    {
+        uint64_t current = m_table[slot].load(std::memory_order_relaxed);
+        if (current == hash)
+            return false;
+
+        if (current == 0)
+        {
+            if (m_table[slot].compare_exchange_strong(current, hash, std::memory_order_relaxed))
+            {
+                // Stop well before the table degrades into long probe chains
+                if (m_tableCount.fetch_add(1, std::memory_order_relaxed) + 1 > m_tableMask - m_tableMask / 8)
+                    m_tableFull.store(true, std::memory_order_relaxed);
+                return true;
+            }
+            if (current == hash)
+                return false;
+        }
+        slot = (slot + 1) & m_tableMask;
+    }
+
+    m_tableFull.store(true, std::memory_order_relaxed);
+    return false;
+}
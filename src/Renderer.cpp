@@ -0,0 +1,79 @@
+#include "Renderer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    unsigned char toChannel(float value)
+    {
+        return static_cast<unsigned char>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+    }
+}
+
+void Renderer::submit(const Sprite& sprite, int layer)
+{
+    if (!sprite.getRenderFlag())
+        return;
+
+    const Rectangle spriteRect = sprite.getRect();
+    const Vector2 spriteCenter = { spriteRect.width / 2.0f, spriteRect.height / 2.0f };
+    const Texture2D texture = sprite.getTexture();
+    const Shader shader = sprite.getShader().shader;
+    const Vector4& offset = sprite.getColorOffset();
+
+    DrawCommand command;
+    command.key = (static_cast<uint64_t>(static_cast<uint16_t>(layer + 0x8000)) << 48) |
+                  (static_cast<uint64_t>(shader.id & 0xFFFF) << 32) |
+                  texture.id;
+    command.order = static_cast<uint32_t>(m_commands.size());
+    command.texture = texture;
+    command.shader = shader;
+    command.source = sprite.getSource();
+    command.destination = {
+        spriteRect.x + spriteCenter.x,  // Rotate about the centre of the sprite
+        spriteRect.y + spriteCenter.y,
+        spriteRect.width,
+        spriteRect.height
+    };
+    command.origin = spriteCenter;
+    command.rotation = sprite.getRotation();
+    command.tint = { toChannel(offset.x), toChannel(offset.y), toChannel(offset.z), toChannel(offset.w) };
+    m_commands.push_back(command);
+}
+
+void Renderer::flush()
+{
+    std::sort(m_commands.begin(), m_commands.end(), [](const DrawCommand& a, const DrawCommand& b)
+    {
+        return a.key != b.key ? a.key < b.key : a.order < b.order;
+    });
+
+    m_batchCount = 0;
+    m_spriteCount = static_cast<int>(m_commands.size());
+    bool shaderActive = false;
+    unsigned int currentShader = 0;
+    unsigned int currentTexture = 0;
+    for (const DrawCommand& command : m_commands)
+    {
+        // Shader switches end the batch explicitly; texture switches are flushed by raylib itself
+        if (!shaderActive || command.shader.id != currentShader)
+        {
+            if (shaderActive)
+                EndShaderMode();
+            BeginShaderMode(command.shader);
+            shaderActive = true;
+            currentShader = command.shader.id;
+            currentTexture = 0;
+        }
+        if (command.texture.id != currentTexture)
+        {
+            currentTexture = command.texture.id;
+            ++m_batchCount;
+        }
+
+        DrawTexturePro(command.texture, command.source, command.destination, command.origin, command.rotation, command.tint);
+    }
+    if (shaderActive)
+        EndShaderMode();
+    m_commands.clear();
+}
@@ -0,0 +1,244 @@
+#include "SpatialHash.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+namespace
+{
+    float distanceSquared(Vector2 point, Rectangle bounds)
+    {
+        const float dx = bounds.x + bounds.width * 0.5f - point.x;
+        const float dy = bounds.y + bounds.height * 0.5f - point.y;
+        return dx * dx + dy * dy;
+    }
+}
+
+int SpatialHash::toCell(float coordinate) const
+{
+    return static_cast<int>(std::floor(coordinate / m_cellSize));
+}
+
+void SpatialHash::update(const std::shared_ptr<Sprite>& sprite, Rectangle bounds)
+{
+    const int left = toCell(bounds.x);
+    const int top = toCell(bounds.y);
+    const int right = std::max(left, static_cast<int>(std::ceil((bounds.x + bounds.width) / m_cellSize)) - 1);
+    const int bottom = std::max(top, static_cast<int>(std::ceil((bounds.y + bounds.height) / m_cellSize)) - 1);
+
+    auto it = m_ids.find(sprite.get());
+    if (it != m_ids.end())
+    {
+        // Still inside the same cells: nothing to re-file
+        Entry& entry = m_entries[it->second];
+        entry.bounds = bounds;
+        if (entry.left == left && entry.top == top && entry.right == right && entry.bottom == bottom)
+            return;
+        unlink(it->second);
+        entry.left = left;
+        entry.top = top;
+        entry.right = right;
+        entry.bottom = bottom;
+        link(it->second);
+        return;
+    }
+
+    int id;
+    if (!m_freeIds.empty())
+    {
+        id = m_freeIds.back();
+        m_freeIds.pop_back();
+    }
+    else
+    {
+        id = static_cast<int>(m_entries.size());
+        m_entries.emplace_back();
+        m_marks.push_back(0);
+    }
+    m_entries[id] = { sprite, bounds, left, top, right, bottom };
+    m_ids.emplace(sprite.get(), id);
+    link(id);
+}
+
+void SpatialHash::remove(const std::shared_ptr<Sprite>& sprite)
+{
+    auto it = m_ids.find(sprite.get());
+    if (it == m_ids.end())
+        return;
+    const int id = it->second;
+    unlink(id);
+    m_entries[id].sprite.reset();
+    m_freeIds.push_back(id);
+    m_ids.erase(it);
+}
+
+void SpatialHash::clear()
+{
+    m_entries.clear();
+    m_freeIds.clear();
+    m_ids.clear();
+    m_cells.clear();
+    m_marks.clear();
+    m_minX = m_minY = INT32_MAX;
+    m_maxX = m_maxY = INT32_MIN;
+}
+
+void SpatialHash::link(int id)
+{
+    const Entry& entry = m_entries[id];
+    for (int y = entry.top; y <= entry.bottom; ++y)
+    {
+        for (int x = entry.left; x <= entry.right; ++x)
+            m_cells[toKey(x, y)].push_back(id);
+    }
+    m_minX = std::min(m_minX, entry.left);
+    m_minY = std::min(m_minY, entry.top);
+    m_maxX = std::max(m_maxX, entry.right);
+    m_maxY = std::max(m_maxY, entry.bottom);
+}
+
+void SpatialHash::unlink(int id)
+{
+    const Entry& entry = m_entries[id];
+    for (int y = entry.top; y <= entry.bottom; ++y)
+    {
+        for (int x = entry.left; x <= entry.right; ++x)
+        {
+            // Empty cells are dropped so the table only grows with occupied area
+            auto cell = m_cells.find(toKey(x, y));
+            std::vector<int>& ids = cell->second;
+            *std::find(ids.begin(), ids.end(), id) = ids.back();
+            ids.pop_back();
+            if (ids.empty())
+                m_cells.erase(cell);
+        }
+    }
+}
+
+bool SpatialHash::mark(int id) const
+{
+    if (m_marks[id] == m_stamp)
+        return false;
+    m_marks[id] = m_stamp;
+    return true;
+}
+
+std::shared_ptr<Sprite> SpatialHash::pick(Vector2 point) const
+{
+    auto cell = m_cells.find(toKey(toCell(point.x), toCell(point.y)));
+    if (cell == m_cells.end())
+        return nullptr;
+
+    int best = -1;
+    float bestDistance = 0.0f;
+    for (int id : cell->second)
+    {
+        const Rectangle& bounds = m_entries[id].bounds;
+        if (!CheckCollisionPointRec(point, bounds))
+            continue;
+        const float distance = distanceSquared(point, bounds);
+        if (best < 0 || distance < bestDistance)
+        {
+            best = id;
+            bestDistance = distance;
+        }
+    }
+    return best >= 0 ? m_entries[best].sprite : nullptr;
+}
+
+void SpatialHash::query(Rectangle area, std::vector<std::shared_ptr<Sprite>>& sprites) const
+{
+    if (m_ids.empty())
+        return;
+
+    // Clamp to the used cells so a huge area doesn't walk empty ones
+    const int left = std::max(toCell(area.x), m_minX);
+    const int top = std::max(toCell(area.y), m_minY);
+    const int right = std::min(toCell(area.x + area.width), m_maxX);
+    const int bottom = std::min(toCell(area.y + area.height), m_maxY);
+    if (++m_stamp == 0)
+    {
+        std::fill(m_marks.begin(), m_marks.end(), 0);
+        m_stamp = 1;
+    }
+    for (int y = top; y <= bottom; ++y)
+    {
+        for (int x = left; x <= right; ++x)
+        {
+            auto cell = m_cells.find(toKey(x, y));
+            if (cell == m_cells.end())
+                continue;
+            for (int id : cell->second)
+            {
+                if (mark(id) && CheckCollisionRecs(area, m_entries[id].bounds))
+                    sprites.push_back(m_entries[id].sprite);
+            }
+        }
+    }
+}
+
+void SpatialHash::nearest(Vector2 point, int count, std::vector<std::shared_ptr<Sprite>>& sprites) const
+{
+    sprites.clear();
+    if (count <= 0 || m_ids.empty())
+        return;
+    if (++m_stamp == 0)
+    {
+        std::fill(m_marks.begin(), m_marks.end(), 0);
+        m_stamp = 1;
+    }
+
+    // Max-heap of the best candidates so far. After ring r every unseen center is at least r cells away
+    std::priority_queue<std::pair<float, int>> best;
+    auto visit = [&](int x, int y)
+    {
+        auto cell = m_cells.find(toKey(x, y));
+        if (cell == m_cells.end())
+            return;
+        for (int id : cell->second)
+        {
+            if (!mark(id))
+                continue;
+            const float distance = distanceSquared(point, m_entries[id].bounds);
+            if (static_cast<int>(best.size()) < count)
+                best.push({ distance, id });
+            else if (distance < best.top().first)
+            {
+                best.pop();
+                best.push({ distance, id });
+            }
+        }
+    };
+
+    const int centerX = toCell(point.x);
+    const int centerY = toCell(point.y);
+    for (int ring = 0; ; ++ring)
+    {
+        // Only the border of the square is new in this ring
+        const int left = centerX - ring;
+        const int top = centerY - ring;
+        const int right = centerX + ring;
+        const int bottom = centerY + ring;
+        for (int y = std::max(top, m_minY); y <= std::min(bottom, m_maxY); ++y)
+        {
+            if (y == top || y == bottom)
+            {
+                for (int x = std::max(left, m_minX); x <= std::min(right, m_maxX); ++x)
+                    visit(x, y);
+                continue;
+            }
+            if (left >= m_minX)
+                visit(left, y);
+            if (right <= m_maxX)
+                visit(right, y);
+        }
+
+        const float reach = ring * m_cellSize;
+        const bool covered = left <= m_minX && top <= m_minY && right >= m_maxX && bottom >= m_maxY;
+        if (covered || (static_cast<int>(best.size()) == count && best.top().first <= reach * reach))
+            break;
+    }
+
+    sprites.resize(best.size());
+    for (size_t i = best.size(); i-- > 0; best.pop())
+        sprites[i] = m_entries[best.top().second].sprite;
+}
@@ -1,36 +1,20 @@
 #include "Sprite.h"
 #include <iostream>
 
-Sprite::Sprite(const char* path, float speed)
-    : m_renderFlag(true), m_speed(speed)
+Sprite::Sprite(TextureHandle texture, Rectangle source, ShaderHandle shader, float speed)
+    : m_renderFlag(true),
+      m_texture(texture),
+      m_textureOriginal(std::move(texture)),
+      m_source(source),
+      m_shader(std::move(shader)),
+      m_speed(speed)
 {
-    m_textureOriginal = LoadTexture(path);
-    m_texture = m_textureOriginal;
     m_rect = {
         0.0f,
         0.0f,
-        static_cast<float>(m_texture.width),
-        static_cast<float>(m_texture.height)
+        source.width,
+        source.height
     };
-
-    m_shader = LoadShader(nullptr, "resources/ColorModifier.fs");
-    if (m_shader.id == 0)  // Shader loading failed
-    {
-        TraceLog(LOG_ERROR, "Failed to load shader. Defaulting to no shader.");
-    }
-    else
-    {
-        Vector4 initialOffset = { 0.0f, 0.0f, 0.0f, 0.0f };
-        int loc = GetShaderLocation(m_shader, "colorOffset");
-        SetShaderValue(m_shader, loc, &initialOffset, SHADER_UNIFORM_VEC4);
-    }
-}
-
-Sprite::~Sprite()
-{
-    UnloadTexture(m_textureOriginal);
-    UnloadTexture(m_texture);
-    UnloadShader(m_shader);
 }
 
 void Sprite::setGameBoardCoordinates(Vector2 gameBoardCoordinates)
@@ -133,16 +117,14 @@ void Sprite::applyAllModifiers()
     combinedOffset.z = std::clamp(combinedOffset.z, 0.0f, 255.0f);
     combinedOffset.w = std::clamp(combinedOffset.w, 0.0f, 255.0f);
 
-    // Normalize
+    // Normalize; the renderer passes it as vertex colour so sprites still batch together
     combinedOffset /= 255.0f;
-
-    int loc = GetShaderLocation(m_shader, "colorOffset");
-    SetShaderValue(m_shader, loc, &combinedOffset, SHADER_UNIFORM_VEC4);
+    m_colorOffset = combinedOffset;
 }
 
 void Sprite::walkPath(const std::vector<Vector2>& path)
 {
-    m_path = {};
+    m_path.clear();
     for (const auto vec : path) 
     {
          Vector2 windowCoordinate = CoordinateTransformer::toWindowCoordinates(vec, m_rect);
@@ -152,7 +134,6 @@ void Sprite::walkPath(const std::vector<Vector2>& path)
 
 void Sprite::resetSurface()
 {
-    UnloadTexture(m_texture);
     m_texture = m_textureOriginal;
 }
 
@@ -161,9 +142,9 @@ bool Sprite::getRenderFlag() const
     return m_renderFlag;
 }
 
-Shader Sprite::getShader() const
+const SpriteShader& Sprite::getShader() const
 {
-    return m_shader;
+    return *m_shader;
 }
 
 void Sprite::onClick()
@@ -192,7 +173,7 @@ Rectangle Sprite::getRect() const
 
 Texture2D Sprite::getTexture() const
 {
-    return m_texture;
+    return *m_texture;
 }
 
 void Sprite::setWindowCoordinates(const Vector2 windowCoordinates)
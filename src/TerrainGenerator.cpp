@@ -0,0 +1,313 @@
+#include "TerrainGenerator.h"
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include "BitGrid.h"
+#include "TileRules.h"
+
+namespace
+{
+    constexpr int SIDE_OFFSETS[4][2] = { { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 } };
+    constexpr Direction::Type SIDE_DIRECTIONS[4] = {
+        Direction::NORTH, Direction::EAST, Direction::SOUTH, Direction::WEST
+    };
+
+}
+
+struct TerrainGenerator::Scratch
+{
+    // Swap-removes a cell from its bucket and files it under a new count; counts of 1 leave the buckets
+    void move(int cell, int from, int to)
+    {
+        std::vector<int>& source = buckets[from];
+        const int slot = slots[cell];
+        slots[source.back()] = slot;
+        source[slot] = source.back();
+        source.pop_back();
+        if (to > 1)
+        {
+            slots[cell] = static_cast<int>(buckets[to].size());
+            buckets[to].push_back(cell);
+            lowestBucket = std::min(lowestBucket, to);
+        }
+    }
+
+    std::vector<uint64_t> domains;                // [cell][word]
+    std::vector<int> counts;                      // Tiles left per cell
+    std::vector<int> stack;                       // Cells whose domain shrank
+    std::vector<std::vector<int>> buckets;        // Uncollapsed cells grouped by tiles left
+    std::vector<int> slots;                       // Position of each cell inside its bucket
+    int lowestBucket{};
+    std::vector<uint64_t> support;                // [side][word]
+    std::mt19937_64 rng;
+};
+
+TerrainGenerator::TerrainGenerator(const std::vector<std::string>& tileNames)
+{
+    if (tileNames.empty())
+        throw std::invalid_argument("TerrainGenerator: No tiles");
+
+    TileRules& rules = TileRules::getInstance();
+    for (const std::string& name : tileNames)
+    {
+        const auto [material, type, direction, variant] = TileRules::parseTileFilename(name);
+        m_ids.push_back(rules.registerTile(name));
+        m_names.push_back(name);
+        m_keys.push_back(material);         // Borders are derived again from the material map when a board loads
+        m_weights.push_back(1.0f);
+    }
+    compile();
+}
+
+void TerrainGenerator::setWeight(const std::string& tileName, float weight)
+{
+    auto it = std::find(m_names.begin(), m_names.end(), tileName);
+    if (it == m_names.end())
+        throw std::out_of_range("setWeight: Unknown tile " + tileName);
+    m_weights[it - m_names.begin()] = std::max(weight, 0.0f);
+}
+
+void TerrainGenerator::compile()
+{
+    const TileRules& rules = TileRules::getInstance();
+    const int tileCount = getTileCount();
+    m_wordsPerDomain = (tileCount + 63) / 64;
+    m_compatible.assign(static_cast<size_t>(tileCount) * SIDE_COUNT * m_wordsPerDomain, 0);
+
+    // Remap the compiled rule table onto this generator's own tile numbering
+    for (int tile = 0; tile < tileCount; ++tile)
+    {
+        for (int side = 0; side < SIDE_COUNT; ++side)
+        {
+            uint64_t* compatible = &m_compatible[(static_cast<size_t>(tile) * SIDE_COUNT + side) * m_wordsPerDomain];
+            for (int neighbor = 0; neighbor < tileCount; ++neighbor)
+            {
+                if (rules.isCompatible(m_ids[tile], SIDE_DIRECTIONS[side], m_ids[neighbor]))
+                    compatible[neighbor >> 6] |= uint64_t{ 1 } << (neighbor & 63);
+            }
+        }
+    }
+
+    // Drop tiles that cannot have a neighbor on some side; they could only cause contradictions
+    m_fullDomain.assign(m_wordsPerDomain, 0);
+    for (int tile = 0; tile < tileCount; ++tile)
+        m_fullDomain[tile >> 6] |= uint64_t{ 1 } << (tile & 63);
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (int tile = 0; tile < tileCount; ++tile)
+        {
+            if (!((m_fullDomain[tile >> 6] >> (tile & 63)) & 1))
+                continue;
+            for (int side = 0; side < SIDE_COUNT; ++side)
+            {
+                const uint64_t* compatible = getCompatible(tile, side);
+                bool supported = false;
+                for (int word = 0; word < m_wordsPerDomain && !supported; ++word)
+                    supported = (compatible[word] & m_fullDomain[word]) != 0;
+                if (!supported)
+                {
+                    m_fullDomain[tile >> 6] &= ~(uint64_t{ 1 } << (tile & 63));
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+    if (std::all_of(m_fullDomain.begin(), m_fullDomain.end(), [](uint64_t word) { return word == 0; }))
+        throw std::runtime_error("TerrainGenerator: Connection rules leave no usable tile");
+
+    m_fullCompatible.assign(static_cast<size_t>(SIDE_COUNT) * m_wordsPerDomain, 0);
+    for (int tile = 0; tile < tileCount; ++tile)
+    {
+        if (!((m_fullDomain[tile >> 6] >> (tile & 63)) & 1))
+            continue;
+        for (int side = 0; side < SIDE_COUNT; ++side)
+        {
+            const uint64_t* compatible = getCompatible(tile, side);
+            for (int word = 0; word < m_wordsPerDomain; ++word)
+                m_fullCompatible[side * m_wordsPerDomain + word] |= compatible[word];
+        }
+    }
+}
+
+bool TerrainGenerator::generate(int columns, int rows, uint64_t seed, std::vector<int>& tiles) const
+{
+    if (columns <= 0 || rows <= 0)
+        throw std::invalid_argument("TerrainGenerator: Invalid dimensions");
+
+    Scratch scratch;
+    for (int attemptIndex = 0; attemptIndex < getMaxAttempts(); ++attemptIndex)
+    {
+        if (!attempt(columns, rows, seed + attemptIndex * 0x9E3779B97F4A7C15ull, scratch))
+            continue;
+
+        const int cells = columns * rows;
+        tiles.resize(cells);
+        for (int cell = 0; cell < cells; ++cell)
+        {
+            const uint64_t* domain = &scratch.domains[static_cast<size_t>(cell) * m_wordsPerDomain];
+            int word = 0;
+            while (!domain[word])
+                ++word;
+            tiles[cell] = word * 64 + BitGrid::countTrailingZeros(domain[word]);
+        }
+        return true;
+    }
+    return false;
+}
+
+bool TerrainGenerator::fill(LevelData& level, uint64_t seed) const
+{
+    std::vector<int> tiles;
+    if (!generate(level.getColumns(), level.getRows(), seed, tiles))
+        return false;
+    for (int y = 0; y < level.getRows(); ++y)
+    {
+        for (int x = 0; x < level.getColumns(); ++x)
+            level.setTileKey(x, y, m_keys[tiles[y * level.getColumns() + x]]);
+    }
+    return true;
+}
+
+bool TerrainGenerator::attempt(int columns, int rows, uint64_t seed, Scratch& scratch) const
+{
+    const int cells = columns * rows;
+    int startCount = 0;
+    for (uint64_t word : m_fullDomain)
+        startCount += BitGrid::countSetBits(word);
+    scratch.rng.seed(seed);
+
+    scratch.domains.resize(static_cast<size_t>(cells) * m_wordsPerDomain);
+    for (int cell = 0; cell < cells; ++cell)
+        std::copy(m_fullDomain.begin(), m_fullDomain.end(), scratch.domains.begin() + static_cast<size_t>(cell) * m_wordsPerDomain);
+    scratch.counts.assign(cells, startCount);
+    scratch.stack.clear();
+
+    // Every cell starts with the same entropy; ties between cells are broken at random
+    scratch.buckets.resize(startCount + 1);
+    for (std::vector<int>& bucket : scratch.buckets)
+        bucket.clear();
+    scratch.slots.resize(cells);
+    scratch.lowestBucket = startCount;
+    if (startCount > 1)
+    {
+        scratch.buckets[startCount].resize(cells);
+        for (int cell = 0; cell < cells; ++cell)
+            scratch.buckets[startCount][cell] = scratch.slots[cell] = cell;
+    }
+
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    while (true)
+    {
+        while (scratch.lowestBucket <= startCount && scratch.buckets[scratch.lowestBucket].empty())
+            ++scratch.lowestBucket;
+        if (scratch.lowestBucket > startCount)
+            break;
+        const std::vector<int>& bucket = scratch.buckets[scratch.lowestBucket];
+        const int cell = bucket[scratch.rng() % bucket.size()];
+        scratch.move(cell, scratch.lowestBucket, 1);
+
+        // Collapse the lowest-entropy cell, then spread the consequences
+        uint64_t* domain = &scratch.domains[static_cast<size_t>(cell) * m_wordsPerDomain];
+        const int tile = chooseTile(domain, unit(scratch.rng));
+        std::fill(domain, domain + m_wordsPerDomain, 0);
+        domain[tile >> 6] = uint64_t{ 1 } << (tile & 63);
+        scratch.counts[cell] = 1;
+        scratch.stack.push_back(cell);
+        if (!propagate(columns, rows, scratch))
+            return false;
+    }
+    return true;
+}
+
+bool TerrainGenerator::propagate(int columns, int rows, Scratch& scratch) const
+{
+    const int words = m_wordsPerDomain;
+    scratch.support.resize(static_cast<size_t>(SIDE_COUNT) * words);
+    while (!scratch.stack.empty())
+    {
+        const int cell = scratch.stack.back();
+        scratch.stack.pop_back();
+        const int x = cell % columns;
+        const int y = cell / columns;
+        const uint64_t* domain = &scratch.domains[static_cast<size_t>(cell) * words];
+
+        // Union of what the remaining tiles allow on each side
+        const uint64_t* support = m_fullCompatible.data();
+        if (!std::equal(domain, domain + words, m_fullDomain.begin()))
+        {
+            std::fill(scratch.support.begin(), scratch.support.end(), 0);
+            for (int word = 0; word < words; ++word)
+            {
+                for (uint64_t bits = domain[word]; bits; bits &= bits - 1)
+                {
+                    const int tile = word * 64 + BitGrid::countTrailingZeros(bits);
+                    const uint64_t* compatible = getCompatible(tile, 0);
+                    for (int i = 0; i < SIDE_COUNT * words; ++i)
+                        scratch.support[i] |= compatible[i];
+                }
+            }
+            support = scratch.support.data();
+        }
+
+        for (int side = 0; side < SIDE_COUNT; ++side)
+        {
+            const int nx = x + SIDE_OFFSETS[side][0];
+            const int ny = y + SIDE_OFFSETS[side][1];
+            if (nx < 0 || ny < 0 || nx >= columns || ny >= rows)
+                continue;
+
+            const int neighbor = ny * columns + nx;
+            uint64_t* neighborDomain = &scratch.domains[static_cast<size_t>(neighbor) * words];
+            const uint64_t* allowed = support + side * words;
+            uint64_t removed = 0;
+            int count = 0;
+            for (int word = 0; word < words; ++word)
+            {
+                const uint64_t kept = neighborDomain[word] & allowed[word];
+                removed |= neighborDomain[word] ^ kept;
+                neighborDomain[word] = kept;
+                count += BitGrid::countSetBits(kept);
+            }
+            if (!removed)
+                continue;
+            if (count == 0)
+                return false;
+
+            scratch.move(neighbor, scratch.counts[neighbor], count);
+            scratch.counts[neighbor] = count;
+            scratch.stack.push_back(neighbor);
+        }
+    }
+    return true;
+}
+
+int TerrainGenerator::chooseTile(const uint64_t* domain, double random) const
+{
+    float total = 0.0f;
+    int last = -1;
+    for (int word = 0; word < m_wordsPerDomain; ++word)
+    {
+        for (uint64_t bits = domain[word]; bits; bits &= bits - 1)
+        {
+            last = word * 64 + BitGrid::countTrailingZeros(bits);
+            total += m_weights[last];
+        }
+    }
+
+    // Weighted pick; with all weights zero the last candidate wins
+    double target = random * total;
+    for (int word = 0; word < m_wordsPerDomain; ++word)
+    {
+        for (uint64_t bits = domain[word]; bits; bits &= bits - 1)
+        {
+            const int tile = word * 64 + BitGrid::countTrailingZeros(bits);
+            target -= m_weights[tile];
+            if (target < 0.0)
+                return tile;
+        }
+    }
+    return last;
+}
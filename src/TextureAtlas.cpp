@@ -0,0 +1,95 @@
+#include "TextureAtlas.h"
+#include <algorithm>
+#include <stdexcept>
+
+void TextureAtlas::build(const std::vector<std::string>& paths, int maxSize)
+{
+    struct Entry
+    {
+        const std::string* path;
+        Image image;
+        Rectangle region;
+    };
+
+    std::vector<Entry> entries;
+    entries.reserve(paths.size());
+    for (const std::string& path : paths)
+    {
+        Image image = LoadImage(path.c_str());
+        if (image.data == nullptr)
+            continue;
+        entries.push_back({ &path, image, {} });
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b)
+    {
+        return a.image.height > b.image.height;
+    });
+
+    // Shelf packing: fill a row left to right, then open a new shelf under the tallest image so far
+    const int padding = getPadding();
+    int shelfX = 0;
+    int shelfY = 0;
+    int shelfHeight = 0;
+    int usedWidth = 0;
+    int usedHeight = 0;
+    for (Entry& entry : entries)
+    {
+        const int width = entry.image.width + padding;
+        const int height = entry.image.height + padding;
+        if (shelfX + width > maxSize)
+        {
+            shelfY += shelfHeight;
+            shelfX = 0;
+            shelfHeight = 0;
+        }
+        if (width > maxSize || shelfY + height > maxSize)
+        {
+            entry.region.width = 0;     // Doesn't fit; keeps its own texture
+            continue;
+        }
+
+        entry.region = {
+            static_cast<float>(shelfX),
+            static_cast<float>(shelfY),
+            static_cast<float>(entry.image.width),
+            static_cast<float>(entry.image.height)
+        };
+        shelfX += width;
+        shelfHeight = std::max(shelfHeight, height);
+        usedWidth = std::max(usedWidth, shelfX);
+        usedHeight = std::max(usedHeight, shelfY + shelfHeight);
+    }
+
+    m_regions.clear();
+    m_texture.reset();
+    if (usedWidth > 0)
+    {
+        Image canvas = GenImageColor(usedWidth, usedHeight, BLANK);
+        for (const Entry& entry : entries)
+        {
+            if (entry.region.width == 0)
+                continue;
+            const Rectangle source = { 0.0f, 0.0f, entry.region.width, entry.region.height };
+            ImageDraw(&canvas, entry.image, source, entry.region, WHITE);
+            m_regions.emplace(*entry.path, entry.region);
+        }
+
+        m_texture = TextureHandle(new Texture2D(LoadTextureFromImage(canvas)), [](const Texture2D* texture)
+        {
+            UnloadTexture(*texture);
+            delete texture;
+        });
+        UnloadImage(canvas);
+    }
+
+    for (const Entry& entry : entries)
+        UnloadImage(entry.image);
+}
+
+Rectangle TextureAtlas::getRegion(const std::string& path) const
+{
+    auto it = m_regions.find(path);
+    if (it == m_regions.end())
+        throw std::out_of_range("TextureAtlas: Image not packed: " + path);
+    return it->second;
+}
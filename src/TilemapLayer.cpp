@@ -0,0 +1,150 @@
+#include "TilemapLayer.h"
+#include <cmath>
+
+bool TilemapLayer::build(const TileGrid& tiles)
+{
+    m_indexTexture.reset();
+    if (tiles.getSize() == 0 || tiles.getSize() > getMaxCells() || !tiles.findTile(0))
+        return false;
+
+    const int columns = tiles.getColumns();
+    const int rows = tiles.getRows();
+    m_columns = columns;
+    m_rows = rows;
+    m_atlas = tiles.findTile(0)->getTextureHandle();
+    m_regions.clear();
+    m_texels.assign(tiles.getSize(), 0);
+    m_cells.assign(tiles.getSize(), nullptr);
+    m_dirty.clear();
+    for (TileIndex cell = 0; cell < tiles.getSize(); ++cell)
+    {
+        if (!encode(cell, tiles.findTile(cell)))
+            return false;
+    }
+
+    Image image = { m_texels.data(), columns, rows, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+    m_indexTexture = TextureHandle(new Texture2D(LoadTextureFromImage(image)), [](const Texture2D* texture)
+    {
+        UnloadTexture(*texture);
+        delete texture;
+    });
+    SetTextureFilter(*m_indexTexture, TEXTURE_FILTER_POINT);
+
+    if (!m_shader)
+    {
+        m_shader = std::shared_ptr<const Shader>(new Shader(LoadShader(nullptr, "resources/Tilemap.fs")), [](const Shader* shader)
+        {
+            UnloadShader(*shader);
+            delete shader;
+        });
+        if (m_shader->id == 0)
+            TraceLog(LOG_ERROR, "Failed to load the tilemap shader.");
+        m_atlasLocation = GetShaderLocation(*m_shader, "atlas");
+        m_regionsLocation = GetShaderLocation(*m_shader, "regions");
+    }
+    const Vector2 mapSize = { static_cast<float>(columns), static_cast<float>(rows) };
+    SetShaderValue(*m_shader, GetShaderLocation(*m_shader, "mapSize"), &mapSize, SHADER_UNIFORM_VEC2);
+    uploadRegions();
+    m_lastUploadCount = columns * rows;
+    return true;
+}
+
+bool TilemapLayer::update(const TileGrid& tiles)
+{
+    m_lastUploadCount = 0;
+    if (!isReady() || static_cast<size_t>(tiles.getSize()) != m_cells.size())
+        return false;
+
+    // Tiles are replaced rather than edited, so a changed pointer marks a changed texel
+    m_dirty.clear();
+    const size_t regionCount = m_regions.size();
+    for (TileIndex cell = 0; cell < tiles.getSize(); ++cell)
+    {
+        const std::shared_ptr<Tile>& tile = tiles.findTile(cell);
+        if (tile == m_cells[cell])
+            continue;
+        if (!encode(cell, tile))
+            return false;
+        m_dirty.push_back(cell);
+    }
+    if (m_regions.size() != regionCount)
+        uploadRegions();
+
+    if (static_cast<int>(m_dirty.size()) > getFullUploadThreshold())
+    {
+        UpdateTexture(*m_indexTexture, m_texels.data());
+        m_lastUploadCount = m_columns * m_rows;
+        return true;
+    }
+    for (TileIndex cell : m_dirty)
+    {
+        const Rectangle texel = {
+            static_cast<float>(cell % m_columns),
+            static_cast<float>(cell / m_columns),
+            1.0f,
+            1.0f
+        };
+        UpdateTextureRec(*m_indexTexture, texel, &m_texels[cell]);
+    }
+    m_lastUploadCount = static_cast<int>(m_dirty.size());
+    return true;
+}
+
+void TilemapLayer::draw() const
+{
+    if (!isReady())
+        return;
+
+    // Blank vertex colour: no colour offset on the ground itself
+    const Rectangle source = { 0.0f, 0.0f, static_cast<float>(m_columns), static_cast<float>(m_rows) };
+    const Rectangle destination = {
+        0.0f,
+        0.0f,
+        static_cast<float>(m_columns * Tile::getSize()),
+        static_cast<float>(m_rows * Tile::getSize())
+    };
+    BeginShaderMode(*m_shader);
+    SetShaderValueTexture(*m_shader, m_atlasLocation, *m_atlas);
+    DrawTexturePro(*m_indexTexture, source, destination, { 0.0f, 0.0f }, 0.0f, BLANK);
+    EndShaderMode();
+}
+
+bool TilemapLayer::encode(TileIndex cell, const std::shared_ptr<Tile>& tile)
+{
+    if (!tile || tile->getTextureHandle() != m_atlas)
+        return false;
+    const int region = findRegion(tile->getSource());
+    if (region < 0)
+        return false;
+
+    const int turns = static_cast<int>(std::lround(tile->getRotation() / 90.0f)) & 3;
+    m_texels[cell] = static_cast<uint32_t>(region) | (static_cast<uint32_t>(turns) << 8) | (0xFFu << 24);
+    m_cells[cell] = tile;
+    return true;
+}
+
+int TilemapLayer::findRegion(Rectangle source)
+{
+    for (size_t i = 0; i < m_regions.size(); ++i)
+    {
+        const Rectangle& region = m_regions[i];
+        if (region.x == source.x && region.y == source.y && region.width == source.width && region.height == source.height)
+            return static_cast<int>(i);
+    }
+    if (static_cast<int>(m_regions.size()) >= getMaxRegions())
+        return -1;
+    m_regions.push_back(source);
+    return static_cast<int>(m_regions.size()) - 1;
+}
+
+void TilemapLayer::uploadRegions() const
+{
+    // The shader samples in normalized atlas coordinates
+    std::vector<Vector4> normalized;
+    normalized.reserve(m_regions.size());
+    const float width = static_cast<float>(m_atlas->width);
+    const float height = static_cast<float>(m_atlas->height);
+    for (const Rectangle& region : m_regions)
+        normalized.push_back({ region.x / width, region.y / height, region.width / width, region.height / height });
+    SetShaderValueV(*m_shader, m_regionsLocation, normalized.data(), SHADER_UNIFORM_VEC4, static_cast<int>(normalized.size()));
+}
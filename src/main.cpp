@@ -1,8 +1,112 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
 #include "Game.h"
+#include "LevelData.h"
+#include "LevelGenerator.h"
+#include "PuzzleSolver.h"
+#include "TerrainGenerator.h"
+#include "TileRules.h"
+
+/**
+ * @brief Solves a level without opening a window and prints the statistics
+ * @return 0 when the level is solvable
+ */
+static int solveLevel(const std::string& path)
+{
+    PuzzleSolver solver(LevelData::load(path));
+    PuzzleSolver::Result result = solver.solve();
+
+    if (result.solved)
+        std::cout << "Solved in " << result.length << " pushes\n";
+    else if (result.tableFull)
+        std::cout << "Gave up: transposition table is full\n";
+    else
+        std::cout << "No solution\n";
+
+    std::cout << "Nodes: " << result.nodes
+              << " (" << static_cast<uint64_t>(result.nodesPerSecond) << " nodes/s)\n"
+              << "Time: " << result.seconds << " s\n"
+              << "Peak memory: " << result.peakMemory / (1024 * 1024) << " MiB\n";
+    return result.solved ? 0 : 1;
+}
+
+/**
+ * @brief Generates levels on every core and writes them best first as level_NNNN.csv
+ */
+static int generateLevels(int count, const std::string& directory)
+{
+    if (count <= 0)
+    {
+        std::cerr << "Usage: Tiles --generate <count> <directory>; count must be a positive number\n";
+        return 1;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+
+    LevelGenerator generator(LevelGenerator::Settings{});
+    std::vector<LevelGenerator::Candidate> candidates = generator.generateMany(count, 1);
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::filesystem::create_directories(directory);
+    for (size_t i = 0; i < candidates.size(); ++i)
+    {
+        std::ostringstream name;
+        name << "level_" << std::setw(4) << std::setfill('0') << i + 1 << ".csv";
+        candidates[i].level.save((std::filesystem::path(directory) / name.str()).string());
+    }
+
+    std::cout << "Wrote " << candidates.size() << " of " << count << " candidates in " << seconds << " s";
+    if (!candidates.empty())
+        std::cout << "; best needs " << candidates.front().solutionLength << " pushes";
+    std::cout << '\n';
+    return candidates.empty() ? 1 : 0;
+}
+
+/**
+ * @brief Collapses a terrain map from the tile sprites and writes it as a level file
+ */
+static int generateTerrain(int columns, int rows, uint64_t seed, const std::string& path)
+{
+    using Clock = std::chrono::steady_clock;
+    TerrainGenerator generator(TileRules::listTileNames("resources/sprites/tiles"));
+    LevelData level(rows, columns);
+
+    const Clock::time_point start = Clock::now();
+    const bool filled = generator.fill(level, seed);
+    const double milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    if (!filled)
+    {
+        std::cout << "Every attempt ran into a contradiction\n";
+        return 1;
+    }
+
+    level.save(path);
+    std::cout << "Collapsed " << columns << "x" << rows << " tiles in " << milliseconds << " ms\n";
+    return 0;
+}
 
 int main(int argc, char** argv)
 {
-    Game game("resources/start.csv", "player");
+    if (argc == 3 && std::strcmp(argv[1], "--solve") == 0)
+        return solveLevel(argv[2]);
+
+    if (argc == 4 && std::strcmp(argv[1], "--generate") == 0)
+        return generateLevels(std::atoi(argv[2]), argv[3]);
+
+    if (argc == 6 && std::strcmp(argv[1], "--terrain") == 0)
+        return generateTerrain(std::atoi(argv[2]), std::atoi(argv[3]), std::strtoull(argv[4], nullptr, 10), argv[5]);
+
+    // A level streamed from disk in chunks, for worlds too large to hold as tiles
+    const bool streamed = argc == 3 && std::strcmp(argv[1], "--stream") == 0;
+    Game game(streamed ? argv[2] : "resources/start.csv", "player",
+              streamed ? GameBoard::LoadMode::Streamed : GameBoard::LoadMode::InMemory);
+    game.setEventDriven(argc == 2 && std::strcmp(argv[1], "--event-driven") == 0);
     game.run();
     return 0;
 }